@@ -0,0 +1,155 @@
+# Flash / RAM budget
+# After each link, reports how the RP2040 flash is used (program code,
+# firmware images, reserved journals, free space) plus static RAM, and fails
+# the build when the program image reaches into the reserved regions at the
+# top of flash or the images exceed FIRMWARE_BUDGET_BYTES. The reserved
+# region sizes are read from src/FlashLayout.h, so the check and the
+# firmware cannot disagree. `make flash_report` prints the report again.
+#
+# Included from CMakeLists.txt it provides add_flash_budget(TARGET); the
+# same file is run in script mode (cmake -P) as the post-build step.
+
+if(NOT CMAKE_SCRIPT_MODE_FILE)
+    set(FLASH_BUDGET_SCRIPT ${CMAKE_CURRENT_LIST_FILE})
+
+    set(PROGRAMMER_FLASH_SIZE 2097152 CACHE STRING "RP2040 flash size in bytes (PICO_FLASH_SIZE_BYTES)")
+    set(FIRMWARE_BUDGET_BYTES 0 CACHE STRING "Upper limit for all firmware images together, 0 = no limit")
+
+    function(add_flash_budget TARGET_NAME)
+        # Same flash size for the firmware's layout and for the check
+        target_compile_definitions(${TARGET_NAME} PRIVATE PICO_FLASH_SIZE_BYTES=${PROGRAMMER_FLASH_SIZE})
+
+        # Reserved sectors, single source of truth in FlashLayout.h
+        file(STRINGS ${CMAKE_CURRENT_LIST_DIR}/src/FlashLayout.h LAYOUT_LINES
+             REGEX "^#define [A-Z_]+_JOURNAL_SECTORS[ ]+[0-9]+")
+        set(RESERVED_REGIONS "")
+        foreach(LINE ${LAYOUT_LINES})
+            string(REGEX MATCH "^#define ([A-Z]+)_JOURNAL_SECTORS[ ]+([0-9]+)" _ "${LINE}")
+            string(TOLOWER ${CMAKE_MATCH_1} REGION)
+            list(APPEND RESERVED_REGIONS "${REGION}=${CMAKE_MATCH_2}")
+        endforeach()
+        string(REPLACE ";" "|" RESERVED_REGIONS "${RESERVED_REGIONS}")
+
+        # Image sizes are known at configure time
+        set(IMAGES "")
+        foreach(FIRMWARE ${FIRMWARE_LIST})
+            file(SIZE ${FIRMWARE_${FIRMWARE}_BINARY_PATH} IMAGE_SIZE)
+            list(APPEND IMAGES "${FIRMWARE}=${IMAGE_SIZE}")
+        endforeach()
+        string(REPLACE ";" "|" IMAGES "${IMAGES}")
+
+        set(BUDGET_ARGS
+            -DMAP_FILE=${CMAKE_CURRENT_BINARY_DIR}/${TARGET_NAME}.elf.map
+            -DFLASH_SIZE=${PROGRAMMER_FLASH_SIZE}
+            -DFIRMWARE_BUDGET=${FIRMWARE_BUDGET_BYTES}
+            "-DRESERVED_REGIONS=${RESERVED_REGIONS}"
+            "-DIMAGES=${IMAGES}"
+        )
+
+        add_custom_command(TARGET ${TARGET_NAME} POST_BUILD
+            COMMAND ${CMAKE_COMMAND} ${BUDGET_ARGS}
+                    "-DARTIFACTS=${CMAKE_CURRENT_BINARY_DIR}/${TARGET_NAME}.elf|${CMAKE_CURRENT_BINARY_DIR}/${TARGET_NAME}.uf2"
+                    -P ${FLASH_BUDGET_SCRIPT}
+            COMMENT "Checking flash budget"
+            VERBATIM
+        )
+        add_custom_target(flash_report
+            COMMAND ${CMAKE_COMMAND} ${BUDGET_ARGS} -P ${FLASH_BUDGET_SCRIPT}
+            DEPENDS ${TARGET_NAME}
+            VERBATIM
+        )
+    endfunction()
+
+    return()
+endif()
+
+# --- Script mode -------------------------------------------------------------
+
+set(XIP_BASE 268435456)      # 0x10000000
+set(SRAM_BASE 536870912)     # 0x20000000
+set(SRAM_SIZE 270336)        # 264 KB incl. scratch banks
+set(SECTOR_SIZE 4096)
+
+include(${CMAKE_CURRENT_LIST_DIR}/report_util.cmake)
+
+macro(report_line LABEL BYTES)
+    pad_left(_bytes "${BYTES}" 9 " ")
+    string(APPEND REPORT "  ${_bytes}  ${LABEL}\n")
+endmacro()
+
+if(NOT EXISTS "${MAP_FILE}")
+    message(FATAL_ERROR "Flash budget: ${MAP_FILE} not found")
+endif()
+
+# Linker symbols for the end of the program image and of static RAM
+file(STRINGS "${MAP_FILE}" SYMBOL_LINES REGEX "(__flash_binary_end|__bss_end__) = ")
+set(FLASH_END "")
+set(BSS_END "")
+foreach(LINE ${SYMBOL_LINES})
+    if(LINE MATCHES "^[ ]+0x([0-9a-fA-F]+)[ ]+__flash_binary_end = ")
+        math(EXPR FLASH_END "0x${CMAKE_MATCH_1}")
+    elseif(LINE MATCHES "^[ ]+0x([0-9a-fA-F]+)[ ]+__bss_end__ = ")
+        math(EXPR BSS_END "0x${CMAKE_MATCH_1}")
+    endif()
+endforeach()
+if(FLASH_END STREQUAL "")
+    message(FATAL_ERROR "Flash budget: __flash_binary_end not found in ${MAP_FILE}")
+endif()
+
+math(EXPR PROGRAM_BYTES "${FLASH_END} - ${XIP_BASE}")
+
+string(REPLACE "|" ";" IMAGES "${IMAGES}")
+string(REPLACE "|" ";" RESERVED_REGIONS "${RESERVED_REGIONS}")
+
+# Reserved regions grow down from the end of flash
+set(RESERVED_BYTES 0)
+foreach(REGION ${RESERVED_REGIONS})
+    string(REGEX MATCH "^([^=]+)=([0-9]+)$" _ "${REGION}")
+    math(EXPR RESERVED_BYTES "${RESERVED_BYTES} + ${CMAKE_MATCH_2} * ${SECTOR_SIZE}")
+endforeach()
+math(EXPR RESERVED_OFFSET "${FLASH_SIZE} - ${RESERVED_BYTES}")
+
+set(IMAGE_BYTES 0)
+foreach(IMAGE ${IMAGES})
+    string(REGEX MATCH "^([^=]+)=([0-9]+)$" _ "${IMAGE}")
+    math(EXPR IMAGE_BYTES "${IMAGE_BYTES} + ${CMAKE_MATCH_2}")
+endforeach()
+math(EXPR CODE_BYTES "${PROGRAM_BYTES} - ${IMAGE_BYTES}")
+math(EXPR FREE_BYTES "${RESERVED_OFFSET} - ${PROGRAM_BYTES}")
+
+set(REPORT "Flash budget (${FLASH_SIZE} bytes):\n")
+report_line("programmer code and data" ${CODE_BYTES})
+foreach(IMAGE ${IMAGES})
+    string(REGEX MATCH "^([^=]+)=([0-9]+)$" _ "${IMAGE}")
+    report_line("image ${CMAKE_MATCH_1}" ${CMAKE_MATCH_2})
+endforeach()
+report_line("free" ${FREE_BYTES})
+foreach(REGION ${RESERVED_REGIONS})
+    string(REGEX MATCH "^([^=]+)=([0-9]+)$" _ "${REGION}")
+    math(EXPR REGION_BYTES "${CMAKE_MATCH_2} * ${SECTOR_SIZE}")
+    report_line("reserved: ${CMAKE_MATCH_1} journal" ${REGION_BYTES})
+endforeach()
+if(NOT BSS_END STREQUAL "")
+    math(EXPR RAM_BYTES "${BSS_END} - ${SRAM_BASE}")
+    string(APPEND REPORT "Static RAM: ${RAM_BYTES} of ${SRAM_SIZE} bytes\n")
+endif()
+message("${REPORT}")
+
+# Enforcement
+set(ERRORS "")
+if(FREE_BYTES LESS 0)
+    math(EXPR OVER "0 - ${FREE_BYTES}")
+    string(APPEND ERRORS "program image overlaps the reserved flash regions by ${OVER} bytes\n")
+endif()
+if(FIRMWARE_BUDGET GREATER 0 AND IMAGE_BYTES GREATER FIRMWARE_BUDGET)
+    string(APPEND ERRORS "firmware images use ${IMAGE_BYTES} bytes, budget is ${FIRMWARE_BUDGET}\n")
+endif()
+
+if(ERRORS)
+    # Don't leave an image behind that would corrupt settings when flashed
+    string(REPLACE "|" ";" ARTIFACTS "${ARTIFACTS}")
+    foreach(ARTIFACT ${ARTIFACTS})
+        file(REMOVE "${ARTIFACT}")
+    endforeach()
+    message(FATAL_ERROR "Flash budget exceeded:\n${ERRORS}")
+endif()
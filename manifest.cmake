@@ -1,15 +1,17 @@
 # CH32V003 Firmware Manifest
-# Reads firmware definitions from firmware.txt (NAME PATH ADDRESS) and generates
-# a C firmware inventory.
+# Reads firmware definitions from firmware.txt (NAME PATH ADDRESS [JOB]) and
+# recipes (RECIPE NAME STEP...), and generates a constexpr C++ firmware
+# inventory with the recipes compiled to bytecode.
 
 # Set the firmware base directory (project root)
 set(FIRMWARE_BASE_DIR ${CMAKE_CURRENT_LIST_DIR})
 
 set(FIRMWARE_LIST "")
 set(FIRMWARE_SOURCES "")
+set(RECIPE_LIST "")
 
 # Function to add a firmware to the build
-function(add_firmware NAME BINARY_PATH LOAD_ADDR)
+function(add_firmware NAME BINARY_PATH LOAD_ADDR JOB)
     # Add to firmware list
     list(APPEND FIRMWARE_LIST ${NAME})
 
@@ -23,6 +25,11 @@ function(add_firmware NAME BINARY_PATH LOAD_ADDR)
     # Set variables for this firmware
     set(FIRMWARE_${NAME}_BINARY_PATH ${BINARY_PATH} CACHE INTERNAL "")
     set(FIRMWARE_${NAME}_LOAD_ADDR ${LOAD_ADDR} CACHE INTERNAL "")
+    set(FIRMWARE_${NAME}_JOB ${JOB} CACHE INTERNAL "")
+
+    # Sizes, layout checks and XAPP metadata are read at configure time;
+    # re-configure when any binary changes
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${BINARY_PATH})
 
     # Update parent scope
     set(FIRMWARE_LIST ${FIRMWARE_LIST} PARENT_SCOPE)
@@ -45,19 +52,37 @@ function(load_firmware_manifest)
         string(REGEX MATCH "^[ \t]*$" IS_EMPTY ${LINE})
 
         if(NOT IS_COMMENT AND NOT IS_EMPTY)
-            # Parse the line: NAME PATH ADDRESS
+            # Parse the line: NAME PATH ADDRESS [JOB]. Images sharing a JOB
+            # are written together, so their layout must not overlap; by
+            # default every image is a job of its own.
             string(REGEX REPLACE "[ \t]+" ";" LINE_PARTS ${LINE})
             list(LENGTH LINE_PARTS NUM_PARTS)
+            list(GET LINE_PARTS 0 FIRST_PART)
 
-            if(NUM_PARTS GREATER_EQUAL 3)
+            if(FIRST_PART STREQUAL "RECIPE")
+                # RECIPE NAME STEP [STEP...]; steps are checked once all
+                # images are known (build_firmware_inventory)
+                if(NUM_PARTS LESS 3)
+                    message(FATAL_ERROR "Invalid recipe (need RECIPE NAME STEP...): ${LINE}")
+                endif()
+                list(GET LINE_PARTS 1 RECIPE_NAME)
+                list(SUBLIST LINE_PARTS 2 -1 RECIPE_STEPS)
+                list(APPEND RECIPE_LIST ${RECIPE_NAME})
+                set(RECIPE_${RECIPE_NAME}_STEPS "${RECIPE_STEPS}" CACHE INTERNAL "")
+                message(STATUS "Added recipe: ${RECIPE_NAME}")
+            elseif(NUM_PARTS GREATER_EQUAL 3)
                 list(GET LINE_PARTS 0 FW_NAME)
                 list(GET LINE_PARTS 1 FW_PATH)
                 list(GET LINE_PARTS 2 FW_ADDR)
+                set(FW_JOB ${FW_NAME})
+                if(NUM_PARTS GREATER_EQUAL 4)
+                    list(GET LINE_PARTS 3 FW_JOB)
+                endif()
 
                 # Check if the binary exists
                 set(BINARY_PATH ${FIRMWARE_BASE_DIR}/${FW_PATH})
                 if(EXISTS ${BINARY_PATH})
-                    add_firmware(${FW_NAME} ${FW_PATH} ${FW_ADDR})
+                    add_firmware(${FW_NAME} ${FW_PATH} ${FW_ADDR} ${FW_JOB})
                 else()
                     message(WARNING "Firmware binary not found: ${BINARY_PATH}")
                 endif()
@@ -68,8 +93,140 @@ function(load_firmware_manifest)
         endif()
     endforeach()
 
-    # Update parent scope with the firmware list
+    # Update parent scope with the firmware and recipe lists
     set(FIRMWARE_LIST ${FIRMWARE_LIST} PARENT_SCOPE)
+    set(RECIPE_LIST ${RECIPE_LIST} PARENT_SCOPE)
+endfunction()
+
+# Application images are loaded at the app header address and start with the
+# 64-byte XAPP header (see "App Header Structure" in README.md)
+set(XAPP_HEADER_ADDR 0x1040)
+set(XAPP_HEADER_SIZE 64)
+set(XAPP_MAGIC 0x50504158)
+
+# Read a little-endian uint32 at byte OFFSET of a hex string
+function(xapp_u32 HEX OFFSET OUT)
+    math(EXPR POS "${OFFSET} * 2")
+    set(VALUE "")
+    foreach(I 0 1 2 3)
+        math(EXPR P "${POS} + ${I} * 2")
+        string(SUBSTRING "${HEX}" ${P} 2 BYTE)
+        set(VALUE "${BYTE}${VALUE}")
+    endforeach()
+    math(EXPR VALUE "0x${VALUE}")
+    set(${OUT} ${VALUE} PARENT_SCOPE)
+endfunction()
+
+# Read a byte at OFFSET of a hex string
+function(xapp_u8 HEX OFFSET OUT)
+    math(EXPR POS "${OFFSET} * 2")
+    string(SUBSTRING "${HEX}" ${POS} 2 BYTE)
+    math(EXPR VALUE "0x${BYTE}")
+    set(${OUT} ${VALUE} PARENT_SCOPE)
+endfunction()
+
+# CRC-32 (IEEE, reflected) of a hex string; the table is built once
+function(xapp_crc32 HEX OUT)
+    get_property(TABLE GLOBAL PROPERTY XAPP_CRC32_TABLE)
+    if(NOT TABLE)
+        foreach(N RANGE 255)
+            set(C ${N})
+            foreach(K RANGE 7)
+                math(EXPR LSB "${C} & 1")
+                if(LSB)
+                    math(EXPR C "(${C} >> 1) ^ 0xEDB88320")
+                else()
+                    math(EXPR C "${C} >> 1")
+                endif()
+            endforeach()
+            list(APPEND TABLE ${C})
+        endforeach()
+        set_property(GLOBAL PROPERTY XAPP_CRC32_TABLE "${TABLE}")
+    endif()
+
+    string(REGEX MATCHALL "[0-9a-fA-F][0-9a-fA-F]" BYTES "${HEX}")
+    set(CRC 0xFFFFFFFF)
+    foreach(BYTE ${BYTES})
+        math(EXPR INDEX "(${CRC} ^ 0x${BYTE}) & 0xFF")
+        list(GET TABLE ${INDEX} ENTRY)
+        math(EXPR CRC "(${CRC} >> 8) ^ ${ENTRY}")
+    endforeach()
+    math(EXPR CRC "${CRC} ^ 0xFFFFFFFF")
+    set(${OUT} ${CRC} PARENT_SCOPE)
+endfunction()
+
+# Validate the XAPP header of an application image and export its metadata
+# as FIRMWARE_<name>_APP_* variables. Any inconsistency fails the build, so
+# an image the bootloader would reject never reaches the programmer.
+function(read_app_header NAME)
+    set(BINARY_PATH ${FIRMWARE_${NAME}_BINARY_PATH})
+    set(FIRMWARE_${NAME}_APP_VALID 0 CACHE INTERNAL "")
+
+    math(EXPR LOAD_ADDR "${FIRMWARE_${NAME}_LOAD_ADDR}")
+    math(EXPR HEADER_ADDR "${XAPP_HEADER_ADDR}")
+    if(NOT LOAD_ADDR EQUAL HEADER_ADDR)
+        return()
+    endif()
+
+    file(SIZE ${BINARY_PATH} FILE_SIZE)
+    if(FILE_SIZE LESS XAPP_HEADER_SIZE)
+        message(FATAL_ERROR "${NAME}: ${FILE_SIZE} bytes, too small for an XAPP header")
+    endif()
+    file(READ ${BINARY_PATH} HEADER LIMIT ${XAPP_HEADER_SIZE} HEX)
+
+    xapp_u32("${HEADER}" 0 MAGIC)
+    xapp_u8("${HEADER}" 4 VER_MAJOR)
+    xapp_u8("${HEADER}" 5 VER_MINOR)
+    xapp_u8("${HEADER}" 6 BL_VER_MIN)
+    xapp_u8("${HEADER}" 7 HW_TYPE)
+    xapp_u32("${HEADER}" 8 APP_SIZE)
+    xapp_u32("${HEADER}" 12 APP_CRC)
+    xapp_u32("${HEADER}" 16 ENTRY_POINT)
+    xapp_u32("${HEADER}" 20 HEADER_CRC)
+
+    math(EXPR EXPECTED_MAGIC "${XAPP_MAGIC}")
+    if(NOT MAGIC EQUAL EXPECTED_MAGIC)
+        math(EXPR MAGIC_HEX "${MAGIC}" OUTPUT_FORMAT HEXADECIMAL)
+        message(FATAL_ERROR "${NAME}: no XAPP header at ${XAPP_HEADER_ADDR} (magic ${MAGIC_HEX})")
+    endif()
+
+    string(SUBSTRING "${HEADER}" 0 40 HEADER_FIELDS)
+    xapp_crc32("${HEADER_FIELDS}" CRC)
+    if(NOT CRC EQUAL HEADER_CRC)
+        message(FATAL_ERROR "${NAME}: XAPP header CRC mismatch")
+    endif()
+
+    # The application follows the header; allow padding to a word boundary
+    # only, since anything beyond would be flashed without CRC coverage
+    math(EXPR PAYLOAD "${FILE_SIZE} - ${XAPP_HEADER_SIZE}")
+    math(EXPR APP_SIZE_ALIGNED "(${APP_SIZE} + 3) / 4 * 4")
+    if(APP_SIZE EQUAL 0 OR APP_SIZE GREATER PAYLOAD OR PAYLOAD GREATER APP_SIZE_ALIGNED)
+        message(FATAL_ERROR "${NAME}: header app_size ${APP_SIZE} does not match the "
+                            "${PAYLOAD} bytes following the header")
+    endif()
+
+    math(EXPR APP_START "${HEADER_ADDR} + ${XAPP_HEADER_SIZE}")
+    math(EXPR APP_END "${APP_START} + ${APP_SIZE}")
+    if(ENTRY_POINT LESS APP_START OR NOT ENTRY_POINT LESS APP_END)
+        math(EXPR ENTRY_HEX "${ENTRY_POINT}" OUTPUT_FORMAT HEXADECIMAL)
+        message(FATAL_ERROR "${NAME}: entry point ${ENTRY_HEX} outside the application")
+    endif()
+
+    file(READ ${BINARY_PATH} APP OFFSET ${XAPP_HEADER_SIZE} LIMIT ${APP_SIZE} HEX)
+    xapp_crc32("${APP}" CRC)
+    if(NOT CRC EQUAL APP_CRC)
+        message(FATAL_ERROR "${NAME}: application CRC mismatch")
+    endif()
+
+    math(EXPR HW_TYPE_HEX "${HW_TYPE}" OUTPUT_FORMAT HEXADECIMAL)
+    message(STATUS "  ${NAME}: XAPP v${VER_MAJOR}.${VER_MINOR}, hw ${HW_TYPE_HEX}, "
+                   "bootloader >= ${BL_VER_MIN}, ${APP_SIZE} bytes")
+
+    set(FIRMWARE_${NAME}_APP_VALID 1 CACHE INTERNAL "")
+    set(FIRMWARE_${NAME}_APP_VER_MAJOR ${VER_MAJOR} CACHE INTERNAL "")
+    set(FIRMWARE_${NAME}_APP_VER_MINOR ${VER_MINOR} CACHE INTERNAL "")
+    set(FIRMWARE_${NAME}_APP_BL_VER_MIN ${BL_VER_MIN} CACHE INTERNAL "")
+    set(FIRMWARE_${NAME}_APP_HW_TYPE ${HW_TYPE_HEX} CACHE INTERNAL "")
 endfunction()
 
 # Function to build all firmware and generate C arrays
@@ -95,6 +252,8 @@ function(build_firmware_inventory TARGET_NAME)
         # Get file size for the length variable
         file(SIZE ${BINARY_PATH} BINARY_SIZE)
 
+        read_app_header(${FIRMWARE})
+
         add_custom_command(
             OUTPUT ${OUTPUT_BASE}.h ${OUTPUT_BASE}.c
             COMMAND ${CMAKE_COMMAND} -E echo "// Generated from ${BINARY_NAME}" > ${OUTPUT_BASE}.c
@@ -113,40 +272,140 @@ function(build_firmware_inventory TARGET_NAME)
         list(APPEND GENERATED_SOURCES ${OUTPUT_BASE}.c)
     endforeach()
 
-    # Generate inventory header and source
+    # Generate the inventory: a constexpr C++ table whose layout is checked
+    # by static_asserts against the target geometry in TargetLayout.h
     set(INVENTORY_HEADER ${CMAKE_CURRENT_BINARY_DIR}/src/firmware_inventory.h)
-    set(INVENTORY_SOURCE ${CMAKE_CURRENT_BINARY_DIR}/src/firmware_inventory.c)
 
-    set(HEADER_CONTENT "// Generated firmware inventory\\n#pragma once\\n\\n#include <stdint.h>\\n#include <stdbool.h>\\n\\n")
-    set(SOURCE_CONTENT "// Generated firmware inventory\\n#include \"firmware_inventory.h\"\\n\\n")
+    list(LENGTH FIRMWARE_LIST FW_COUNT)
 
+    set(HEADER_CONTENT "// Generated firmware inventory\\n#pragma once\\n\\n#include <stdint.h>\\n#include <array>\\n#include \"TargetLayout.h\"\\n#include \"Recipe.h\"\\n\\n")
+    set(HEADER_CONTENT "${HEADER_CONTENT}extern \"C\" {\\n")
     foreach(FIRMWARE ${FIRMWARE_LIST})
         string(REGEX REPLACE "[^a-zA-Z0-9_]" "_" FIRMWARE_SAFE ${FIRMWARE})
-        set(HEADER_CONTENT "${HEADER_CONTENT}extern const unsigned char firmware_${FIRMWARE_SAFE}_bin[];\\nextern const unsigned int firmware_${FIRMWARE_SAFE}_bin_len;\\n\\n")
-        set(SOURCE_CONTENT "${SOURCE_CONTENT}#include \"firmware_${FIRMWARE_SAFE}.h\"\\n")
+        set(HEADER_CONTENT "${HEADER_CONTENT}extern const unsigned char firmware_${FIRMWARE_SAFE}_bin[];\\n")
     endforeach()
+    set(HEADER_CONTENT "${HEADER_CONTENT}}\\n\\n")
 
-    set(HEADER_CONTENT "${HEADER_CONTENT}typedef struct {\\n    const char* name;\\n    const unsigned char* data;\\n    unsigned int size;\\n    uint32_t load_addr;\\n} firmware_info_t;\\n\\nextern const firmware_info_t firmware_list[];\\nextern const int firmware_count;\\n")
+    set(HEADER_CONTENT "${HEADER_CONTENT}// XAPP header fields of application images, checked at configure time\\nstruct firmware_app_t {\\n    bool valid;\\n    uint8_t ver_major;\\n    uint8_t ver_minor;\\n    uint8_t bl_ver_min;\\n    uint8_t hw_type;\\n};\\n\\n")
+    set(HEADER_CONTENT "${HEADER_CONTENT}struct firmware_info_t {\\n    const char* name;\\n    const unsigned char* data;\\n    unsigned int size;\\n    uint32_t load_addr;\\n    firmware_app_t app;\\n\\n    // Derived at compile time\\n    uint32_t first_sector;\\n    uint32_t last_sector;\\n};\\n\\n")
+    set(HEADER_CONTENT "${HEADER_CONTENT}constexpr firmware_info_t makeFirmwareInfo(const char* name, const unsigned char* data,\\n                                           unsigned int size, uint32_t load_addr,\\n                                           firmware_app_t app = {}) {\\n    return { name, data, size, load_addr, app,\\n             TargetLayout::firstSector(load_addr),\\n             TargetLayout::lastSector(load_addr, size) };\\n}\\n\\n")
 
-    set(SOURCE_CONTENT "${SOURCE_CONTENT}\\nconst firmware_info_t firmware_list[] = {\\n")
+    set(HEADER_CONTENT "${HEADER_CONTENT}inline constexpr std::array<firmware_info_t, ${FW_COUNT}> firmware_list = {{\\n")
     foreach(FIRMWARE ${FIRMWARE_LIST})
         string(REGEX REPLACE "[^a-zA-Z0-9_]" "_" FIRMWARE_SAFE ${FIRMWARE})
         file(SIZE ${FIRMWARE_${FIRMWARE}_BINARY_PATH} FIRMWARE_FILE_SIZE)
-        set(SOURCE_CONTENT "${SOURCE_CONTENT}    {\"${FIRMWARE}\", firmware_${FIRMWARE_SAFE}_bin, ${FIRMWARE_FILE_SIZE}, ${FIRMWARE_${FIRMWARE}_LOAD_ADDR}},\\n")
+        if(FIRMWARE_${FIRMWARE}_APP_VALID)
+            set(APP_INFO ", { true, ${FIRMWARE_${FIRMWARE}_APP_VER_MAJOR}, ${FIRMWARE_${FIRMWARE}_APP_VER_MINOR}, ${FIRMWARE_${FIRMWARE}_APP_BL_VER_MIN}, ${FIRMWARE_${FIRMWARE}_APP_HW_TYPE} }")
+        else()
+            set(APP_INFO "")
+        endif()
+        set(HEADER_CONTENT "${HEADER_CONTENT}    makeFirmwareInfo(\"${FIRMWARE}\", firmware_${FIRMWARE_SAFE}_bin, ${FIRMWARE_FILE_SIZE}, ${FIRMWARE_${FIRMWARE}_LOAD_ADDR}${APP_INFO}),\\n")
+    endforeach()
+    set(HEADER_CONTENT "${HEADER_CONTENT}}};\\n\\ninline constexpr int firmware_count = (int)firmware_list.size();\\n\\n")
+
+    # Per-image layout checks
+    set(HEADER_CONTENT "${HEADER_CONTENT}// Layout checks\\n")
+    set(INDEX 0)
+    foreach(FIRMWARE ${FIRMWARE_LIST})
+        set(FW "firmware_list[${INDEX}]")
+        set(HEADER_CONTENT "${HEADER_CONTENT}static_assert(TargetLayout::fitsFlash(${FW}.load_addr, ${FW}.size),\\n              \"${FIRMWARE}: image does not fit in target flash\");\\n")
+        set(HEADER_CONTENT "${HEADER_CONTENT}static_assert(TargetLayout::avoidsBootState(${FW}.load_addr, ${FW}.size),\\n              \"${FIRMWARE}: image overlaps the boot-state page\");\\n")
+        set(HEADER_CONTENT "${HEADER_CONTENT}static_assert(TargetLayout::wordAligned(${FW}.load_addr),\\n              \"${FIRMWARE}: load address is not word aligned\");\\n")
+        math(EXPR INDEX "${INDEX} + 1")
+    endforeach()
+
+    # Images of the same job are written together and must be disjoint
+    set(INDEX_A 0)
+    foreach(FIRMWARE_A ${FIRMWARE_LIST})
+        set(INDEX_B 0)
+        foreach(FIRMWARE_B ${FIRMWARE_LIST})
+            if(INDEX_B GREATER INDEX_A AND
+               FIRMWARE_${FIRMWARE_A}_JOB STREQUAL FIRMWARE_${FIRMWARE_B}_JOB)
+                set(A "firmware_list[${INDEX_A}]")
+                set(B "firmware_list[${INDEX_B}]")
+                set(HEADER_CONTENT "${HEADER_CONTENT}static_assert(!TargetLayout::overlaps(${A}.load_addr, ${A}.size, ${B}.load_addr, ${B}.size),\\n              \"job ${FIRMWARE_${FIRMWARE_A}_JOB}: ${FIRMWARE_A} and ${FIRMWARE_B} overlap\");\\n")
+            endif()
+            math(EXPR INDEX_B "${INDEX_B} + 1")
+        endforeach()
+        math(EXPR INDEX_A "${INDEX_A} + 1")
     endforeach()
-    set(SOURCE_CONTENT "${SOURCE_CONTENT}};\\n\\nconst int firmware_count = sizeof(firmware_list) / sizeof(firmware_list[0]);\\n")
+
+    # Recipes: steps compiled to bytecode (opcodes in src/Recipe.h). Images
+    # flashed by one recipe are written in one session, like a job.
+    set(HEADER_CONTENT "${HEADER_CONTENT}\\n// Recipes\\n")
+    set(RECIPE_ENTRIES "")
+    set(RECIPE_COUNT 0)
+    foreach(RECIPE ${RECIPE_LIST})
+        list(FIND FIRMWARE_LIST ${RECIPE} CLASH)
+        if(NOT CLASH EQUAL -1)
+            message(FATAL_ERROR "Recipe ${RECIPE}: name already used by an image")
+        endif()
+
+        set(CODE "")
+        set(FLASHED "")
+        set(SKIP FALSE)
+        foreach(STEP ${RECIPE_${RECIPE}_STEPS})
+            string(REGEX MATCH "^([a-zA-Z]+)(:(.*))?$" MATCHED "${STEP}")
+            string(TOLOWER "${CMAKE_MATCH_1}" OP)
+            set(ARG "${CMAKE_MATCH_3}")
+            if(OP STREQUAL "flash")
+                list(FIND FIRMWARE_LIST "${ARG}" IMAGE_INDEX)
+                if(IMAGE_INDEX EQUAL -1)
+                    message(WARNING "Recipe ${RECIPE}: image '${ARG}' not available, recipe skipped")
+                    set(SKIP TRUE)
+                    break()
+                endif()
+                if(IMAGE_INDEX GREATER 255)
+                    message(FATAL_ERROR "Recipe ${RECIPE}: image '${ARG}' beyond the 8-bit operand range")
+                endif()
+                set(CODE "${CODE}RECIPE_FLASH, ${IMAGE_INDEX}, ")
+                list(APPEND FLASHED ${IMAGE_INDEX})
+            elseif(OP STREQUAL "wipe" OR OP STREQUAL "uid" OR OP STREQUAL "boot" OR OP STREQUAL "log")
+                if(NOT ARG STREQUAL "")
+                    message(FATAL_ERROR "Recipe ${RECIPE}: step '${STEP}' takes no argument")
+                endif()
+                string(TOUPPER "${OP}" OP_UPPER)
+                set(CODE "${CODE}RECIPE_${OP_UPPER}, ")
+            else()
+                message(FATAL_ERROR "Recipe ${RECIPE}: unknown step '${STEP}' "
+                                    "(expected wipe, flash:IMAGE, uid, boot or log)")
+            endif()
+        endforeach()
+        if(SKIP)
+            continue()
+        endif()
+
+        set(HEADER_CONTENT "${HEADER_CONTENT}inline constexpr uint8_t recipe_${RECIPE_COUNT}_code[] = { ${CODE}RECIPE_END };\\n")
+        set(RECIPE_ENTRIES "${RECIPE_ENTRIES}    { \"${RECIPE}\", recipe_${RECIPE_COUNT}_code },\\n")
+
+        # Each flash step erases the sectors its image touches, so images
+        # written in the same session must not share a sector: a later step
+        # would wipe part of an earlier, already verified image
+        set(CHECKED "")
+        foreach(INDEX_A ${FLASHED})
+            foreach(INDEX_B ${CHECKED})
+                if(NOT INDEX_A EQUAL INDEX_B)
+                    set(A "firmware_list[${INDEX_A}]")
+                    set(B "firmware_list[${INDEX_B}]")
+                    list(GET FIRMWARE_LIST ${INDEX_A} NAME_A)
+                    list(GET FIRMWARE_LIST ${INDEX_B} NAME_B)
+                    set(HEADER_CONTENT "${HEADER_CONTENT}static_assert(!TargetLayout::sharesSector(${A}.first_sector, ${A}.last_sector, ${B}.first_sector, ${B}.last_sector),\\n              \"recipe ${RECIPE}: ${NAME_B} and ${NAME_A} share a target sector\");\\n")
+                endif()
+            endforeach()
+            list(APPEND CHECKED ${INDEX_A})
+        endforeach()
+
+        math(EXPR RECIPE_COUNT "${RECIPE_COUNT} + 1")
+    endforeach()
+    set(HEADER_CONTENT "${HEADER_CONTENT}\\ninline constexpr std::array<recipe_info_t, ${RECIPE_COUNT}> recipe_list = {{\\n${RECIPE_ENTRIES}}};\\n\\ninline constexpr int recipe_count = (int)recipe_list.size();\\n")
 
     string(REPLACE "\\n" "\n" HEADER_CONTENT_FORMATTED "${HEADER_CONTENT}")
-    string(REPLACE "\\n" "\n" SOURCE_CONTENT_FORMATTED "${SOURCE_CONTENT}")
     file(WRITE ${INVENTORY_HEADER} "${HEADER_CONTENT_FORMATTED}")
-    file(WRITE ${INVENTORY_SOURCE} "${SOURCE_CONTENT_FORMATTED}")
 
-    list(APPEND GENERATED_SOURCES ${INVENTORY_SOURCE})
     target_sources(${TARGET_NAME} PRIVATE ${GENERATED_SOURCES})
     target_include_directories(${TARGET_NAME} PRIVATE ${CMAKE_CURRENT_BINARY_DIR}/src)
 
-    list(LENGTH FIRMWARE_LIST FW_COUNT)
-    message(STATUS "Configured firmware inventory with ${FW_COUNT} firmware images")
+    message(STATUS "Configured firmware inventory with ${FW_COUNT} firmware images and ${RECIPE_COUNT} recipes")
 endfunction()
 
 # Load firmware definitions
@@ -0,0 +1,129 @@
+# Static RAM map
+# After each link, sums the RAM-resident input sections (.data, .bss, RAM
+# functions, ...) of the linker map per object file and prints them largest
+# first, so the footprint of each module is visible in every build.
+#
+# Included from CMakeLists.txt it provides add_ram_map(TARGET); the same
+# file is run in script mode (cmake -P) as the post-build step.
+
+if(NOT CMAKE_SCRIPT_MODE_FILE)
+    set(RAM_MAP_SCRIPT ${CMAKE_CURRENT_LIST_FILE})
+
+    function(add_ram_map TARGET_NAME)
+        # pico_add_extra_outputs() writes <target>.elf.map
+        set(MAP_FILE ${CMAKE_CURRENT_BINARY_DIR}/${TARGET_NAME}.elf.map)
+        set(REPORT_FILE ${CMAKE_CURRENT_BINARY_DIR}/${TARGET_NAME}.ram.txt)
+        add_custom_command(TARGET ${TARGET_NAME} POST_BUILD
+            COMMAND ${CMAKE_COMMAND} -DMAP_FILE=${MAP_FILE} -DREPORT_FILE=${REPORT_FILE}
+                    -P ${RAM_MAP_SCRIPT}
+            COMMENT "RAM map: ${REPORT_FILE}"
+            VERBATIM
+        )
+    endfunction()
+
+    return()
+endif()
+
+# --- Script mode -------------------------------------------------------------
+
+include(${CMAKE_CURRENT_LIST_DIR}/report_util.cmake)
+
+if(NOT EXISTS "${MAP_FILE}")
+    message(WARNING "RAM map: ${MAP_FILE} not found")
+    return()
+endif()
+
+file(STRINGS "${MAP_FILE}" MAP_LINES)
+
+# Input sections that end up in RAM (copied .data incl. RAM functions,
+# zeroed .bss, uninitialized data and the scratch banks)
+set(RAM_SECTION_REGEX "^(\\.data|\\.bss|\\.time_critical|\\.uninitialized_data|\\.scratch_|\\.sdata|\\.sbss|COMMON)")
+
+set(MODULES "")
+set(PENDING_SECTION "")
+set(IN_DISCARDED FALSE)
+
+foreach(LINE IN LISTS MAP_LINES)
+    # Only the memory map part counts; discarded sections are listed before it
+    if(LINE MATCHES "^Discarded input sections")
+        set(IN_DISCARDED TRUE)
+    elseif(LINE MATCHES "^Memory map")
+        set(IN_DISCARDED FALSE)
+    endif()
+    if(IN_DISCARDED)
+        continue()
+    endif()
+
+    set(SECTION "")
+    set(SIZE "")
+    set(OBJECT "")
+    if(LINE MATCHES "^ ([^ ]+)[ ]+0x[0-9a-fA-F]+[ ]+0x([0-9a-fA-F]+) (.+)$")
+        # " .bss.foo  0x20000000  0x10 path/to/file.obj" on one line
+        set(SECTION ${CMAKE_MATCH_1})
+        set(SIZE ${CMAKE_MATCH_2})
+        set(OBJECT ${CMAKE_MATCH_3})
+    elseif(LINE MATCHES "^ ([^ ]+)$")
+        # Long section name; address, size and file follow on the next line
+        set(PENDING_SECTION ${CMAKE_MATCH_1})
+        continue()
+    elseif(PENDING_SECTION AND LINE MATCHES "^[ ]+0x[0-9a-fA-F]+[ ]+0x([0-9a-fA-F]+) (.+)$")
+        set(SECTION ${PENDING_SECTION})
+        set(SIZE ${CMAKE_MATCH_1})
+        set(OBJECT ${CMAKE_MATCH_2})
+    endif()
+    set(PENDING_SECTION "")
+
+    if(NOT SECTION OR NOT SECTION MATCHES "${RAM_SECTION_REGEX}")
+        continue()
+    endif()
+
+    math(EXPR BYTES "0x${SIZE}")
+    if(BYTES EQUAL 0)
+        continue()
+    endif()
+
+    # Module = object file name, archive members reduced to the member
+    string(STRIP "${OBJECT}" OBJECT)
+    if(OBJECT MATCHES "\\(([^)]+)\\)$")
+        set(OBJECT ${CMAKE_MATCH_1})
+    endif()
+    get_filename_component(MODULE "${OBJECT}" NAME)
+    string(REGEX REPLACE "\\.(c|cpp|S)?\\.obj$|\\.o$" "" MODULE "${MODULE}")
+    string(MAKE_C_IDENTIFIER "${MODULE}" KEY)
+
+    if(NOT DEFINED RAM_${KEY})
+        set(RAM_${KEY} 0)
+        list(APPEND MODULES ${MODULE})
+    endif()
+    math(EXPR RAM_${KEY} "${RAM_${KEY}} + ${BYTES}")
+endforeach()
+
+# Largest first: sort "<zero-padded size> <module>" strings descending
+set(ROWS "")
+set(TOTAL 0)
+foreach(MODULE IN LISTS MODULES)
+    string(MAKE_C_IDENTIFIER "${MODULE}" KEY)
+    set(BYTES ${RAM_${KEY}})
+    math(EXPR TOTAL "${TOTAL} + ${BYTES}")
+    pad_left(KEYED ${BYTES} 10 "0")
+    list(APPEND ROWS "${KEYED} ${MODULE}")
+endforeach()
+list(SORT ROWS ORDER DESCENDING)
+
+set(REPORT "Static RAM by module (bytes):\n")
+foreach(ROW IN LISTS ROWS)
+    string(REGEX MATCH "^0*([0-9]+) (.*)$" _ "${ROW}")
+    set(BYTES ${CMAKE_MATCH_1})
+    if(BYTES STREQUAL "")
+        set(BYTES 0)
+    endif()
+    set(NAME ${CMAKE_MATCH_2})
+    pad_left(BYTES ${BYTES} 8 " ")
+    string(APPEND REPORT "  ${BYTES}  ${NAME}\n")
+endforeach()
+string(APPEND REPORT "  --------\n")
+pad_left(TOTAL ${TOTAL} 8 " ")
+string(APPEND REPORT "  ${TOTAL}  total\n")
+
+file(WRITE "${REPORT_FILE}" "${REPORT}")
+message("${REPORT}")
@@ -0,0 +1,13 @@
+# Helpers shared by the post-build report scripts (flash_budget.cmake,
+# ram_map.cmake). Included in script mode only.
+
+# Right-align VALUE in WIDTH characters using FILL
+function(pad_left OUT VALUE WIDTH FILL)
+    set(RESULT "${VALUE}")
+    string(LENGTH "${RESULT}" LEN)
+    while(LEN LESS WIDTH)
+        set(RESULT "${FILL}${RESULT}")
+        math(EXPR LEN "${LEN} + 1")
+    endwhile()
+    set(${OUT} "${RESULT}" PARENT_SCOPE)
+endfunction()
@@ -0,0 +1,42 @@
+#include "ButtonClassifier.h"
+
+ButtonClassifier::ButtonClassifier(uint32_t short_ms, uint32_t long_ms)
+    : short_ms(short_ms), long_ms(long_ms),
+      pressed(false), long_reported(false), press_ms(0) {
+}
+
+ButtonEvent ButtonClassifier::feed(bool is_press, uint32_t time_ms) {
+    if (is_press) {
+        if (!pressed) {
+            pressed = true;
+            long_reported = false;
+            press_ms = time_ms;
+        }
+        return BUTTON_NONE;
+    }
+
+    if (!pressed) return BUTTON_NONE;  // Release without press (e.g. at boot)
+    pressed = false;
+    if (long_reported) return BUTTON_NONE;
+
+    // Duration between the two edges, not between two polls
+    uint32_t duration = time_ms - press_ms;
+    if (duration < short_ms) return BUTTON_SHORT_PRESS;
+    if (duration >= long_ms) return BUTTON_LONG_PRESS;  // Released before a poll saw it
+    return BUTTON_NONE;
+}
+
+ButtonEvent ButtonClassifier::resync(bool level, uint32_t now_ms) {
+    if (level == pressed) return BUTTON_NONE;
+    return feed(level, now_ms);
+}
+
+ButtonEvent ButtonClassifier::poll(uint32_t now_ms) {
+    if (!pressed || long_reported) return BUTTON_NONE;
+
+    if ((now_ms - press_ms) >= long_ms) {
+        long_reported = true;
+        return BUTTON_LONG_PRESS;
+    }
+    return BUTTON_HELD;
+}
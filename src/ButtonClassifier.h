@@ -0,0 +1,44 @@
+#ifndef BUTTON_CLASSIFIER_H
+#define BUTTON_CLASSIFIER_H
+
+#include <stdint.h>
+
+enum ButtonEvent {
+    BUTTON_NONE,
+    BUTTON_SHORT_PRESS,
+    BUTTON_LONG_PRESS,
+    BUTTON_HELD
+};
+
+// Short/long press decision from edge timestamps. Pure logic with the
+// clock passed in, so it behaves the same however late the caller polls
+// and can be driven with synthetic times on the host.
+//
+//   release < short_ms after press             -> BUTTON_SHORT_PRESS
+//   held >= long_ms (seen by poll or release)  -> BUTTON_LONG_PRESS, once
+//   anything in between                        -> no event
+class ButtonClassifier {
+public:
+    ButtonClassifier(uint32_t short_ms, uint32_t long_ms);
+
+    // Edge from the event queue
+    ButtonEvent feed(bool pressed, uint32_t time_ms);
+
+    // Long press / held state while the button stays down
+    ButtonEvent poll(uint32_t now_ms);
+
+    // After lost edges: adopt the sampled level, as an edge at now_ms, if
+    // it disagrees with the tracked state
+    ButtonEvent resync(bool level, uint32_t now_ms);
+
+    bool isPressed() const { return pressed; }
+
+private:
+    uint32_t short_ms;
+    uint32_t long_ms;
+    bool pressed;
+    bool long_reported;
+    uint32_t press_ms;
+};
+
+#endif // BUTTON_CLASSIFIER_H
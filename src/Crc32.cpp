@@ -0,0 +1,69 @@
+#include "Crc32.h"
+
+#if PICO_ON_DEVICE
+  #include "hardware/dma.h"
+#endif
+
+// 256-entry table for the reflected polynomial 0xEDB88320, built at compile time
+struct Crc32Table {
+    uint32_t entries[256];
+
+    constexpr Crc32Table() : entries() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int j = 0; j < 8; j++) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : (crc >> 1);
+            }
+            entries[i] = crc;
+        }
+    }
+};
+static constexpr Crc32Table crc32_table;
+
+int Crc32::dma_channel = -1;
+
+void Crc32::init() {
+#if PICO_ON_DEVICE
+    if (dma_channel < 0) {
+        dma_channel = dma_claim_unused_channel(false);
+    }
+#endif
+}
+
+uint32_t Crc32::computeSoftware(const void* data, size_t len) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc = crc32_table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+uint32_t Crc32::compute(const void* data, size_t len) {
+#if PICO_ON_DEVICE
+    if (dma_channel >= 0 && len >= CRC32_DMA_MIN_LEN) {
+        // Byte transfers into a dummy sink; the sniffer sees every byte.
+        // CRC32R mode bit-reverses the input, and reading the result
+        // reversed + inverted yields the reflected (zlib) CRC.
+        static uint8_t sink;
+        dma_channel_config c = dma_channel_get_default_config(dma_channel);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_sniff_enable(&c, true);
+
+        dma_sniffer_set_data_accumulator(0xFFFFFFFF);
+        dma_sniffer_set_output_reverse_enabled(true);
+        dma_sniffer_set_output_invert_enabled(true);
+        dma_sniffer_enable(dma_channel, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+
+        dma_channel_configure(dma_channel, &c, &sink, data, len, true);
+        dma_channel_wait_for_finish_blocking(dma_channel);
+
+        uint32_t crc = dma_sniffer_get_data_accumulator();
+        dma_sniffer_disable();
+        return crc;
+    }
+#endif
+    return computeSoftware(data, len);
+}
@@ -0,0 +1,25 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Buffers shorter than this use the table; DMA setup costs more
+#define CRC32_DMA_MIN_LEN  64
+
+// CRC-32 (IEEE 802.3, reflected, as zlib/Ethernet) for settings records,
+// images and XIP flash regions. On the RP2040 long buffers are hashed by a
+// DMA channel with the sniffer in CRC-32 mode, so the CPU does no per-byte
+// work; short buffers, and builds without the DMA (host), use a
+// table-driven software implementation with identical results.
+class Crc32 {
+public:
+    static void init();
+    static uint32_t compute(const void* data, size_t len);
+    static uint32_t computeSoftware(const void* data, size_t len);
+
+private:
+    static int dma_channel;  // -1 until init() claims one
+};
+
+#endif // CRC32_H
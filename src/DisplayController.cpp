@@ -124,34 +124,18 @@ static inline uint8_t transposeColumn(const uint8_t* glyph, int col) {
     return column_byte;
 }
 
-// SSD1306 init commands for 128x32
-static const uint8_t ssd1306_init_cmds[] = {
-    0xAE,       // Display off
-    0xD5, 0x80, // Set display clock divide ratio
-    0xA8, 0x1F, // Set multiplex ratio (32-1)
-    0xD3, 0x00, // Set display offset = 0
-    0x40,       // Set start line = 0
-    0x8D, 0x14, // Enable charge pump
-    0x20, 0x00, // Horizontal addressing mode
-    0xA1,       // Segment remap (normal, will be set by flip)
-    0xC8,       // COM scan direction (normal, will be set by flip)
-    0xDA, 0x02, // COM pins hardware config (sequential, for 128x32)
-    0x81, 0x8F, // Set contrast
-    0xD9, 0xF1, // Set pre-charge period
-    0xDB, 0x40, // Set VCOMH deselect level
-    0xA4,       // Entire display ON (follow RAM)
-    0xA6,       // Normal display (not inverted)
-    0xAF,       // Display on
-};
-
 DisplayController::DisplayController()
-    : display_present(false), needs_redraw(false), is_flipped(false),
+    : display_present(false), i2c_freq(DISPLAY_I2C_FREQ), needs_redraw(false), is_flipped(false),
       is_sleeping(false), last_activity_ms(0),
-      sleep_timeout_ms(DISPLAY_SLEEP_MS_DEFAULT) {
+      sleep_timeout_ms(DISPLAY_SLEEP_MS_DEFAULT), last_progress_ms(0),
+      last_render_us(0), last_flush_bytes(0) {
     memset(framebuffer, 0, sizeof(framebuffer));
     menu_line[0] = '\0';
     state_line[0] = '\0';
     info_line[0] = '\0';
+    position_text[0] = '\0';
+    idle_info[0] = '\0';
+    show_position = false;
 }
 
 DisplayController::~DisplayController() {
@@ -164,9 +148,32 @@ bool DisplayController::probe() {
     return ret == 2;
 }
 
+// Stress the bus at the current rate: write a few full-width data bursts
+// and require every byte to be ACKed. The panel is still off and the RAM is
+// overwritten by the first flush, so nothing is visible.
+bool DisplayController::testLink() {
+    uint8_t buf[DISPLAY_WIDTH + 1];
+    memset(buf, 0, sizeof(buf));
+    buf[0] = 0x40;  // data prefix
+    for (int i = 0; i < 4; i++) {
+        if (i2c_write_timeout_us(DISPLAY_I2C, DISPLAY_ADDR, buf, sizeof(buf),
+                                 false, 50000) != (int)sizeof(buf)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void DisplayController::sendCommand(uint8_t cmd) {
     uint8_t buf[2] = { 0x00, cmd };
     i2c_write_timeout_us(DISPLAY_I2C, DISPLAY_ADDR, buf, 2, false, 50000);
+    last_flush_bytes += 2;
+}
+
+// buf[0] must hold the 0x40 data prefix
+void DisplayController::sendData(const uint8_t* buf, size_t len) {
+    i2c_write_timeout_us(DISPLAY_I2C, DISPLAY_ADDR, buf, len, false, 100000);
+    last_flush_bytes += len;
 }
 
 void DisplayController::sendCommands(const uint8_t* cmds, size_t len) {
@@ -176,7 +183,7 @@ void DisplayController::sendCommands(const uint8_t* cmds, size_t len) {
 }
 
 void DisplayController::initDisplay(bool flipped) {
-    sendCommands(ssd1306_init_cmds, sizeof(ssd1306_init_cmds));
+    sendCommands(DisplayPanel::INIT_CMDS, sizeof(DisplayPanel::INIT_CMDS));
 
     // Apply flip setting
     is_flipped = flipped;
@@ -185,49 +192,83 @@ void DisplayController::initDisplay(bool flipped) {
 }
 
 void DisplayController::init(bool flipped) {
-    // Initialize I2C1
-    i2c_init(DISPLAY_I2C, DISPLAY_I2C_FREQ);
+    // Initialize I2C1 at Fast-mode Plus first
+    i2c_init(DISPLAY_I2C, DISPLAY_I2C_FREQ_FAST);
     gpio_set_function(DISPLAY_SDA_PIN, GPIO_FUNC_I2C);
     gpio_set_function(DISPLAY_SCL_PIN, GPIO_FUNC_I2C);
     gpio_pull_up(DISPLAY_SDA_PIN);
     gpio_pull_up(DISPLAY_SCL_PIN);
 
-    // Probe for display
-    if (!probe()) {
-        display_present = false;
-        printf_g("// WARNING: No display detected on I2C1 (0x%02X)\n", DISPLAY_ADDR);
-        return;
+    // Probe for display; fall back to 400 kHz if 1 MHz is not reliable
+    // (weak pull-ups, long wiring, slow controller)
+    i2c_freq = DISPLAY_I2C_FREQ_FAST;
+    if (!probe() || !testLink()) {
+        i2c_freq = DISPLAY_I2C_FREQ;
+        i2c_set_baudrate(DISPLAY_I2C, DISPLAY_I2C_FREQ);
+        if (!probe()) {
+            display_present = false;
+            printf_g("// WARNING: No display detected on I2C1 (0x%02X)\n", DISPLAY_ADDR);
+            return;
+        }
     }
 
     display_present = true;
-    printf_g("// Display detected on I2C1 (0x%02X)\n", DISPLAY_ADDR);
+    printf_g("// Display detected on I2C1 (0x%02X, %s, %lu kHz)\n", DISPLAY_ADDR,
+             DisplayPanel::NAME, (unsigned long)(i2c_freq / 1000));
 
     initDisplay(flipped);
     last_activity_ms = to_ms_since_boot(get_absolute_time());
 
     // Initial content
-    snprintf(info_line, sizeof(info_line), "PewPewCH32 %s", PROGRAMMER_VERSION);
+    setDefaultInfo();
 
     needs_redraw = true;
 }
 
 void DisplayController::flush() {
-    if (!display_present) return;
+    last_flush_bytes = 0;
+    flushPages<DisplayPanel>(0, DISPLAY_PAGES - 1);
+}
 
-    // Set column and page address to cover full display
-    sendCommand(0x21); sendCommand(0); sendCommand(127);  // Column range
-    sendCommand(0x22); sendCommand(0); sendCommand(DISPLAY_PAGES - 1);  // Page range
+// Send pages [first_page, last_page] of the framebuffer. Only the variant for
+// the selected panel is instantiated, so the addressing choice costs nothing
+// at runtime.
+template <typename Panel>
+void DisplayController::flushPages(int first_page, int last_page) {
+    if (!display_present) return;
 
-    // Send framebuffer as data in chunks
     static const int CHUNK = 128;
-    for (int offset = 0; offset < DISPLAY_BUF_SIZE; offset += CHUNK) {
-        int len = DISPLAY_BUF_SIZE - offset;
-        if (len > CHUNK) len = CHUNK;
-
-        uint8_t buf[CHUNK + 1];
-        buf[0] = 0x40;  // data prefix
-        memcpy(buf + 1, framebuffer + offset, len);
-        i2c_write_timeout_us(DISPLAY_I2C, DISPLAY_ADDR, buf, len + 1, false, 100000);
+    uint8_t buf[CHUNK + 1];
+    buf[0] = 0x40;  // data prefix
+
+    if constexpr (Panel::PAGE_ADDRESSING) {
+        // SH1106: set page + column start, then one row of data, per page
+        const uint8_t col = Panel::COLUMN_OFFSET;
+        for (int page = first_page; page <= last_page; page++) {
+            sendCommand(0xB0 | page);              // Page address
+            sendCommand(0x00 | (col & 0x0F));      // Column low nibble
+            sendCommand(0x10 | (col >> 4));        // Column high nibble
+
+            for (int x = 0; x < Panel::WIDTH; x += CHUNK) {
+                int len = Panel::WIDTH - x;
+                if (len > CHUNK) len = CHUNK;
+                memcpy(buf + 1, framebuffer + page * Panel::WIDTH + x, len);
+                sendData(buf, len + 1);
+            }
+        }
+    } else {
+        // SSD1306: set column and page window, then stream it in one go
+        sendCommand(0x21); sendCommand(Panel::COLUMN_OFFSET);
+        sendCommand(Panel::COLUMN_OFFSET + Panel::WIDTH - 1);  // Column range
+        sendCommand(0x22); sendCommand(first_page); sendCommand(last_page);  // Page range
+
+        int end = (last_page + 1) * Panel::WIDTH;
+        for (int offset = first_page * Panel::WIDTH; offset < end; offset += CHUNK) {
+            int len = end - offset;
+            if (len > CHUNK) len = CHUNK;
+            memcpy(buf + 1, framebuffer + offset, len);
+            sendData(buf, len + 1);
+        }
     }
 }
 
@@ -295,6 +336,7 @@ void DisplayController::drawStringPixel(int x, int y, const char* str) {
 }
 
 void DisplayController::render() {
+    uint64_t start_us = time_us_64();
     clear();
 
     // Line 0 (y=0): Selected menu entry — inverted, centered
@@ -313,14 +355,35 @@ void DisplayController::render() {
         drawStringPixel(0, 13, state_line);
     }
 
-    // Line 3 (y=24): Version / contextual info
+    // Menu position, right-aligned on the state line while idle
+    if (show_position && position_text[0]) {
+        int x = DISPLAY_WIDTH - (int)strlen(position_text) * FONT_WIDTH;
+        drawStringPixel(x, 13, position_text);
+    }
+
+    // Last page (y=24 on 128x32, y=56 on 128x64): Version / contextual info
     if (info_line[0]) {
-        drawString(0, 24, info_line);
+        drawString(0, DISPLAY_HEIGHT - FONT_HEIGHT, info_line);
     }
 
+    last_render_us = (uint32_t)(time_us_64() - start_us);
     flush();
 }
 
+// Print the framebuffer as a plain (ASCII) PBM image, one pixel row per
+// line, so it can be captured from the terminal and diffed on the host.
+void DisplayController::dumpPbm() const {
+    printf("P1\n%d %d\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        const uint8_t* row = framebuffer + (y / 8) * DISPLAY_WIDTH;
+        uint8_t mask = 1 << (y % 8);
+        for (int x = 0; x < DISPLAY_WIDTH; x++) {
+            putchar((row[x] & mask) ? '1' : '0');
+        }
+        putchar('\n');
+    }
+}
+
 void DisplayController::update() {
     if (!display_present) return;
 
@@ -348,15 +411,21 @@ void DisplayController::wake() {
     }
 }
 
-void DisplayController::setMenuEntry(const char* name) {
+void DisplayController::setMenuEntry(const char* name, int number, int total) {
     wake();
     snprintf(menu_line, sizeof(menu_line), "%s", name);
+    if (total > 1) {
+        snprintf(position_text, sizeof(position_text), "%d/%d", number, total - 1);
+    } else {
+        position_text[0] = '\0';
+    }
     needs_redraw = true;
 }
 
 void DisplayController::setSystemState(SystemState state) {
     wake();
-    snprintf(state_line, sizeof(state_line), "%s", StateMachine::getStateName(state));
+    snprintf(state_line, sizeof(state_line), "%s", systemStateName(state));
+    show_position = (state == STATE_IDLE);
 
     switch (state) {
         case STATE_CHECKING_TARGET:
@@ -372,12 +441,74 @@ void DisplayController::setSystemState(SystemState state) {
             snprintf(info_line, sizeof(info_line), "Check cable!");
             break;
         default:
-            snprintf(info_line, sizeof(info_line), "PewPewCH32 %s", PROGRAMMER_VERSION);
+            setDefaultInfo();
             break;
     }
     needs_redraw = true;
 }
 
+void DisplayController::setIdleInfo(const char* text) {
+    if (strcmp(idle_info, text) == 0) return;
+    snprintf(idle_info, sizeof(idle_info), "%s", text);
+    if (show_position) {
+        setDefaultInfo();
+        needs_redraw = true;
+    }
+}
+
+void DisplayController::setDefaultInfo() {
+    if (idle_info[0]) {
+        snprintf(info_line, sizeof(info_line), "%s", idle_info);
+    } else {
+        snprintf(info_line, sizeof(info_line), "PewPewCH32 %s", PROGRAMMER_VERSION);
+    }
+}
+
+// Progress bar + ETA on the bottom page. Called from inside the blocking
+// programming loop, so it draws and flushes that single page directly
+// instead of going through update()/render().
+void DisplayController::setProgress(uint32_t done, uint32_t total, uint32_t eta_ms) {
+    if (!display_present || is_sleeping || total == 0) return;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if (done > 0 && done < total &&
+        (now - last_progress_ms) < DISPLAY_PROGRESS_INTERVAL_MS) {
+        return;
+    }
+    last_progress_ms = now;
+    last_activity_ms = now;
+
+    // ETA text, right-aligned ("--" until the first estimate is available)
+    char eta[6];
+    if (eta_ms == UINT32_MAX) {
+        snprintf(eta, sizeof(eta), " --");
+    } else {
+        uint32_t secs = (eta_ms + 999) / 1000;
+        if (secs > 999) secs = 999;
+        snprintf(eta, sizeof(eta), "%3lus", (unsigned long)secs);
+    }
+    int text_x = DISPLAY_WIDTH - (int)strlen(eta) * FONT_WIDTH;
+
+    int page = DISPLAY_PAGES - 1;
+    uint8_t* row = framebuffer + page * DISPLAY_WIDTH;
+    memset(row, 0, DISPLAY_WIDTH);
+
+    // Bar: 6px tall outline, filled proportionally
+    int bar_width = text_x - 4;
+    int fill = (int)((uint64_t)bar_width * done / total);
+    for (int x = 0; x < bar_width; x++) {
+        if (x == 0 || x == bar_width - 1 || x < fill) {
+            row[x] = 0x7E;
+        } else {
+            row[x] = 0x42;
+        }
+    }
+    drawString(text_x, page * 8, eta);
+
+    last_flush_bytes = 0;
+    flushPages<DisplayPanel>(page, page);
+}
+
 void DisplayController::setFlipped(bool flipped) {
     is_flipped = flipped;
     if (!display_present) return;
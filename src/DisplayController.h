@@ -2,27 +2,33 @@
 #define DISPLAY_CONTROLLER_H
 
 #include <stdint.h>
-#include "StateMachine.h"
+#include <stddef.h>
+#include "SystemState.h"
+#include "DisplayPanel.h"
 
 // I2C configuration
 #define DISPLAY_SDA_PIN   6
 #define DISPLAY_SCL_PIN   7
-#define DISPLAY_I2C_FREQ  400000
+#define DISPLAY_I2C_FREQ  400000   // Fast-mode fallback
+#define DISPLAY_I2C_FREQ_FAST 1000000  // Fast-mode Plus, tried first
 #define DISPLAY_ADDR      0x3C
 
-// Display dimensions
-#define DISPLAY_WIDTH     128
-#define DISPLAY_HEIGHT    32
+// Display dimensions (from the compile-time panel selection)
+#define DISPLAY_WIDTH     (DisplayPanel::WIDTH)
+#define DISPLAY_HEIGHT    (DisplayPanel::HEIGHT)
 #define DISPLAY_PAGES     (DISPLAY_HEIGHT / 8)
 #define DISPLAY_BUF_SIZE  (DISPLAY_WIDTH * DISPLAY_PAGES)
 
 // Screensaver default: blank display after 5 minutes of inactivity
 #define DISPLAY_SLEEP_MS_DEFAULT  (5 * 60 * 1000)
 
+// Minimum interval between progress bar updates during programming
+#define DISPLAY_PROGRESS_INTERVAL_MS  100
+
 // Font dimensions
 #define FONT_WIDTH        8
 #define FONT_HEIGHT       8
-#define FONT_CHARS_PER_LINE (DISPLAY_WIDTH / FONT_WIDTH)  // 16
+#define FONT_CHARS_PER_LINE (DISPLAY_WIDTH / FONT_WIDTH)  // 16 on 128px panels
 
 class DisplayController {
 public:
@@ -32,40 +38,60 @@ public:
     void init(bool flipped);
     void update();
 
-    void setMenuEntry(const char* name);
+    void setMenuEntry(const char* name, int number, int total);
     void setSystemState(SystemState state);
     void setFlipped(bool flipped);
     void setSleepTimeout(uint32_t ms);
+    void setProgress(uint32_t done, uint32_t total, uint32_t eta_ms);
+    void setIdleInfo(const char* text);  // Replaces the version line; "" restores it
     void forceRedraw() { wake(); needs_redraw = true; }
 
     bool isPresent() const { return display_present; }
+    uint32_t getI2cFreq() const { return i2c_freq; }
     bool isSleeping() const { return is_sleeping; }
 
+    // Diagnostics: framebuffer snapshot as PBM, render time and I2C bytes of
+    // the last redraw/flush
+    void dumpPbm() const;
+    uint32_t getLastRenderUs() const { return last_render_us; }
+    uint32_t getLastFlushBytes() const { return last_flush_bytes; }
+
 private:
     uint8_t framebuffer[DISPLAY_BUF_SIZE];
     bool display_present;
+    uint32_t i2c_freq;
     bool needs_redraw;
     bool is_flipped;
     bool is_sleeping;
     uint32_t last_activity_ms;
     uint32_t sleep_timeout_ms;
+    uint32_t last_progress_ms;
+    uint32_t last_render_us;
+    uint32_t last_flush_bytes;
 
     // Cached display content
     char menu_line[FONT_CHARS_PER_LINE + 1];
     char state_line[FONT_CHARS_PER_LINE + 1];
     char info_line[FONT_CHARS_PER_LINE + 1];
+    char position_text[FONT_CHARS_PER_LINE + 1];  // "n/total", idle only
+    char idle_info[FONT_CHARS_PER_LINE + 1];      // e.g. yield of selected image
+    bool show_position;
 
     // Low-level SSD1306 operations
     bool probe();
+    bool testLink();
     void sendCommand(uint8_t cmd);
+    void sendData(const uint8_t* buf, size_t len);
     void sendCommands(const uint8_t* cmds, size_t len);
     void initDisplay(bool flipped);
     void flush();
+    template <typename Panel> void flushPages(int first_page, int last_page);
 
     // Drawing operations
     void clear();
     void drawString(int x, int y, const char* str);
     void drawStringInverted(int x, int y, const char* str);
+    void setDefaultInfo();
     void drawStringPixel(int x, int y, const char* str);
 
     void render();
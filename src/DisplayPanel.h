@@ -0,0 +1,104 @@
+#ifndef DISPLAY_PANEL_H
+#define DISPLAY_PANEL_H
+
+#include <stdint.h>
+
+// Compile-time description of the supported OLED panels. DisplayController
+// is built against exactly one of these (selected with DISPLAY_PANEL), so
+// geometry, init sequence and flush strategy are all resolved at compile time.
+
+// SSD1306 128x32 — the original PewPewCH32 panel
+struct PanelSSD1306_128x32 {
+    static constexpr const char* NAME = "SSD1306 128x32";
+    static constexpr int WIDTH = 128;
+    static constexpr int HEIGHT = 32;
+    static constexpr int COLUMN_OFFSET = 0;
+    static constexpr bool PAGE_ADDRESSING = false;  // Horizontal addressing, one stream
+
+    static constexpr uint8_t INIT_CMDS[] = {
+        0xAE,       // Display off
+        0xD5, 0x80, // Set display clock divide ratio
+        0xA8, 0x1F, // Set multiplex ratio (32-1)
+        0xD3, 0x00, // Set display offset = 0
+        0x40,       // Set start line = 0
+        0x8D, 0x14, // Enable charge pump
+        0x20, 0x00, // Horizontal addressing mode
+        0xA1,       // Segment remap (normal, will be set by flip)
+        0xC8,       // COM scan direction (normal, will be set by flip)
+        0xDA, 0x02, // COM pins hardware config (sequential, for 128x32)
+        0x81, 0x8F, // Set contrast
+        0xD9, 0xF1, // Set pre-charge period
+        0xDB, 0x40, // Set VCOMH deselect level
+        0xA4,       // Entire display ON (follow RAM)
+        0xA6,       // Normal display (not inverted)
+        0xAF,       // Display on
+    };
+};
+
+// SSD1306 128x64
+struct PanelSSD1306_128x64 {
+    static constexpr const char* NAME = "SSD1306 128x64";
+    static constexpr int WIDTH = 128;
+    static constexpr int HEIGHT = 64;
+    static constexpr int COLUMN_OFFSET = 0;
+    static constexpr bool PAGE_ADDRESSING = false;
+
+    static constexpr uint8_t INIT_CMDS[] = {
+        0xAE,       // Display off
+        0xD5, 0x80, // Set display clock divide ratio
+        0xA8, 0x3F, // Set multiplex ratio (64-1)
+        0xD3, 0x00, // Set display offset = 0
+        0x40,       // Set start line = 0
+        0x8D, 0x14, // Enable charge pump
+        0x20, 0x00, // Horizontal addressing mode
+        0xA1,       // Segment remap (normal, will be set by flip)
+        0xC8,       // COM scan direction (normal, will be set by flip)
+        0xDA, 0x12, // COM pins hardware config (alternative, for 128x64)
+        0x81, 0xCF, // Set contrast
+        0xD9, 0xF1, // Set pre-charge period
+        0xDB, 0x40, // Set VCOMH deselect level
+        0xA4,       // Entire display ON (follow RAM)
+        0xA6,       // Normal display (not inverted)
+        0xAF,       // Display on
+    };
+};
+
+// SH1106 128x64 — 132-column RAM with the visible window at column 2,
+// page addressing only (no 0x20/0x21/0x22 commands)
+struct PanelSH1106_128x64 {
+    static constexpr const char* NAME = "SH1106 128x64";
+    static constexpr int WIDTH = 128;
+    static constexpr int HEIGHT = 64;
+    static constexpr int COLUMN_OFFSET = 2;
+    static constexpr bool PAGE_ADDRESSING = true;  // One stream per page
+
+    static constexpr uint8_t INIT_CMDS[] = {
+        0xAE,       // Display off
+        0xD5, 0x80, // Set display clock divide ratio
+        0xA8, 0x3F, // Set multiplex ratio (64-1)
+        0xD3, 0x00, // Set display offset = 0
+        0x40,       // Set start line = 0
+        0xAD, 0x8B, // DC-DC converter on
+        0xA1,       // Segment remap (normal, will be set by flip)
+        0xC8,       // COM scan direction (normal, will be set by flip)
+        0xDA, 0x12, // COM pins hardware config (alternative)
+        0x81, 0x80, // Set contrast
+        0xD9, 0x22, // Set pre-charge period
+        0xDB, 0x35, // Set VCOM deselect level
+        0xA4,       // Entire display ON (follow RAM)
+        0xA6,       // Normal display (not inverted)
+        0xAF,       // Display on
+    };
+};
+
+// Panel selection: -DDISPLAY_PANEL=PanelSH1106_128x64 etc. (see CMakeLists.txt)
+#ifndef DISPLAY_PANEL
+#define DISPLAY_PANEL PanelSSD1306_128x32
+#endif
+
+using DisplayPanel = DISPLAY_PANEL;
+
+static_assert(DisplayPanel::HEIGHT % 8 == 0, "panel height must be a whole number of pages");
+static_assert(DisplayPanel::HEIGHT >= 32, "layout needs at least four pages");
+
+#endif // DISPLAY_PANEL_H
@@ -0,0 +1,70 @@
+#include "FirmwareMenu.h"
+#include <ctype.h>
+
+int FirmwareMenu::count() {
+#ifdef FIRMWARE_INVENTORY_ENABLED
+    return firmware_count + recipe_count + 2;
+#else
+    return 1;
+#endif
+}
+
+MenuItemKind FirmwareMenu::kind(int index) {
+#ifdef FIRMWARE_INVENTORY_ENABLED
+    if (index == 0) return MENU_WIPE;
+    if (index > firmware_count + recipe_count) return MENU_REBOOT;
+    if (index > firmware_count) return MENU_RECIPE;
+#endif
+    return MENU_FIRMWARE;
+}
+
+const char* FirmwareMenu::name(int index) {
+    if (!isValid(index)) return "???";
+#ifdef FIRMWARE_INVENTORY_ENABLED
+    switch (kind(index)) {
+        case MENU_WIPE:   return "WIPE FLASH";
+        case MENU_REBOOT: return "REBOOT";
+        case MENU_RECIPE: return recipe_list[index - firmware_count - 1].name;
+        default:          return firmware_list[index - 1].name;
+    }
+#else
+    return "fallback";
+#endif
+}
+
+#ifdef FIRMWARE_INVENTORY_ENABLED
+const firmware_info_t* FirmwareMenu::firmware(int index) {
+    if (index < 1 || index > firmware_count) return nullptr;
+    return &firmware_list[index - 1];
+}
+
+const recipe_info_t* FirmwareMenu::recipe(int index) {
+    if (index <= firmware_count || index > firmware_count + recipe_count) return nullptr;
+    return &recipe_list[index - firmware_count - 1];
+}
+#endif
+
+int FirmwareMenu::next(int index) {
+    return (index + 1) % count();
+}
+
+int FirmwareMenu::prev(int index) {
+    return (index + count() - 1) % count();
+}
+
+int FirmwareMenu::findByPrefix(const char* prefix, int from) {
+    if (!prefix[0]) return -1;
+
+    int n = count();
+    for (int i = 0; i < n; i++) {
+        int index = (from + i) % n;
+        const char* entry = name(index);
+        const char* p = prefix;
+        while (*p && tolower((unsigned char)*p) == tolower((unsigned char)*entry)) {
+            p++;
+            entry++;
+        }
+        if (!*p) return index;
+    }
+    return -1;
+}
@@ -0,0 +1,59 @@
+#ifndef FIRMWARE_MENU_H
+#define FIRMWARE_MENU_H
+
+#include <stdint.h>
+
+#ifdef FIRMWARE_INVENTORY_ENABLED
+  #include "firmware_inventory.h"
+#endif
+
+// Entries per terminal page
+#define MENU_PAGE_SIZE  10
+
+// Longest blue-flash sequence used to indicate an image number
+#define MENU_MAX_FLASHES  9
+
+enum MenuItemKind {
+    MENU_WIPE,
+    MENU_FIRMWARE,
+    MENU_RECIPE,
+    MENU_REBOOT
+};
+
+// The selectable menu: [0] WIPE FLASH, [1..firmware_count] images, then
+// the recipes, then REBOOT. Without an inventory there is a single
+// entry, the built-in fallback image. Index == the number shown to the
+// operator, so quick-select by number is a range check.
+class FirmwareMenu {
+public:
+    static int count();
+    static bool isValid(int index) { return index >= 0 && index < count(); }
+
+    static MenuItemKind kind(int index);
+    static const char* name(int index);
+#ifdef FIRMWARE_INVENTORY_ENABLED
+    static const firmware_info_t* firmware(int index);
+    static const recipe_info_t* recipe(int index);
+#endif
+
+    // Images and recipes are production cycles (counted in the stats);
+    // wipe and reboot are service actions
+    static bool isProduction(int index) {
+        return isValid(index) && (kind(index) == MENU_FIRMWARE || kind(index) == MENU_RECIPE);
+    }
+
+    // Wrapping navigation
+    static int next(int index);
+    static int prev(int index);
+
+    // Paging for list views
+    static int pageCount() { return (count() + MENU_PAGE_SIZE - 1) / MENU_PAGE_SIZE; }
+    static int pageOf(int index) { return index / MENU_PAGE_SIZE; }
+    static int pageStart(int page) { return page * MENU_PAGE_SIZE; }
+
+    // First entry at or after 'from' (wrapping) whose name starts with
+    // prefix, case-insensitive; -1 if none
+    static int findByPrefix(const char* prefix, int from);
+};
+
+#endif // FIRMWARE_MENU_H
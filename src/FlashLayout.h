@@ -0,0 +1,29 @@
+#ifndef FLASH_LAYOUT_H
+#define FLASH_LAYOUT_H
+
+#include "hardware/flash.h"
+
+// Reserved regions at the top of the RP2040 flash, growing downwards from
+// the end. The program image (including the firmware inventory) must end
+// below RESERVED_FLASH_OFFSET.
+//
+//   PICO_FLASH_SIZE_BYTES  ┬
+//                          │ settings journal  (SETTINGS_JOURNAL_SECTORS)
+//   SETTINGS_FLASH_OFFSET  ┼
+//                          │ production stats  (STATS_JOURNAL_SECTORS)
+//   STATS_FLASH_OFFSET     ┴ = RESERVED_FLASH_OFFSET
+//
+// flash_budget.cmake reads the *_JOURNAL_SECTORS values from this file and
+// fails the build if the program image reaches RESERVED_FLASH_OFFSET.
+
+#define SETTINGS_JOURNAL_SECTORS 2
+#define SETTINGS_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - SETTINGS_JOURNAL_SECTORS * FLASH_SECTOR_SIZE)
+#define SETTINGS_FLASH_ADDR   (XIP_BASE + SETTINGS_FLASH_OFFSET)
+
+#define STATS_JOURNAL_SECTORS 4
+#define STATS_FLASH_OFFSET    (SETTINGS_FLASH_OFFSET - STATS_JOURNAL_SECTORS * FLASH_SECTOR_SIZE)
+#define STATS_FLASH_ADDR      (XIP_BASE + STATS_FLASH_OFFSET)
+
+#define RESERVED_FLASH_OFFSET STATS_FLASH_OFFSET
+
+#endif // FLASH_LAYOUT_H
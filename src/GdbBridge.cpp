@@ -0,0 +1,78 @@
+#include "GdbBridge.h"
+#include "InputHandler.h"
+#include "GDBServer.h"
+#include "tusb.h"
+
+GdbBridge::GdbBridge(GDBServer* gdb)
+    : gdb(gdb),
+      active(false),
+      out_pending(false),
+      out_byte(0),
+      bytes_in(0),
+      bytes_out(0) {
+}
+
+void GdbBridge::begin() {
+    if (active) return;
+    gdb->reset();
+    out_pending = false;
+    bytes_in = 0;
+    bytes_out = 0;
+    InputHandler::suspendBootsel();
+    active = true;
+}
+
+void GdbBridge::end() {
+    if (!active) return;
+    active = false;
+    InputHandler::resumeBootsel();
+    gdb->reset();
+}
+
+bool GdbBridge::isHostConnected() const {
+    return tud_cdc_n_connected(USB_CDC_GDB);
+}
+
+bool GdbBridge::flushPending() {
+    if (!out_pending) return true;
+    if (tud_cdc_n_write_available(USB_CDC_GDB) == 0) return false;
+    tud_cdc_n_write(USB_CDC_GDB, &out_byte, 1);
+    out_pending = false;
+    bytes_out++;
+    return true;
+}
+
+bool GdbBridge::update() {
+    if (!active) return false;
+
+    bool connected = isHostConnected();
+    bool moved = false;
+
+    for (int i = 0; i < GDB_MAX_BYTES_PER_UPDATE; i++) {
+        // Backpressure: no new input until the last reply byte is out
+        if (!flushPending()) break;
+
+        char byte_in = 0;
+        bool byte_ivalid = connected && tud_cdc_n_available(USB_CDC_GDB) > 0;
+        if (byte_ivalid) {
+            tud_cdc_n_read(USB_CDC_GDB, &byte_in, 1);
+            bytes_in++;
+        }
+
+        bool byte_ovalid = false;
+        char byte_out = 0;
+        gdb->update(connected, byte_ivalid, byte_in, byte_ovalid, byte_out);
+        if (byte_ovalid) {
+            out_byte = byte_out;
+            out_pending = true;
+        }
+
+        // Server idle: nothing received, nothing to send
+        if (!byte_ivalid && !byte_ovalid) break;
+        moved = true;
+    }
+
+    flushPending();
+    tud_cdc_n_write_flush(USB_CDC_GDB);
+    return moved;
+}
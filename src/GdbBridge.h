@@ -0,0 +1,44 @@
+#ifndef GDB_BRIDGE_H
+#define GDB_BRIDGE_H
+
+#include <stdint.h>
+
+class GDBServer;
+
+// Bytes handed to GDBServer per update() before returning to the main loop
+#define GDB_MAX_BYTES_PER_UPDATE  512
+
+// Connects picorvd's GDBServer to the second USB CDC port (USB_CDC_GDB),
+// so the host can "target remote /dev/ttyACM1". GDBServer consumes and
+// produces one byte per call; update() feeds it everything the host sent
+// and holds back input while the CDC TX FIFO is full, so no reply byte is
+// ever dropped.
+class GdbBridge {
+public:
+    GdbBridge(GDBServer* gdb);
+
+    // Session boundaries. BOOTSEL sampling is suspended in between so its
+    // interrupts-off window never lands inside an SWIO transfer.
+    void begin();
+    void end();
+    bool isActive() const { return active; }
+
+    // Returns true if any byte moved (caller may skip its idle delay)
+    bool update();
+
+    bool isHostConnected() const;
+    uint32_t getBytesIn() const { return bytes_in; }
+    uint32_t getBytesOut() const { return bytes_out; }
+
+private:
+    GDBServer* gdb;
+    bool active;
+    bool out_pending;       // Reply byte waiting for FIFO space
+    char out_byte;
+    uint32_t bytes_in;
+    uint32_t bytes_out;
+
+    bool flushPending();
+};
+
+#endif // GDB_BRIDGE_H
@@ -0,0 +1,37 @@
+#include "InputEventQueue.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+static_assert((INPUT_EVENT_QUEUE_SIZE & (INPUT_EVENT_QUEUE_SIZE - 1)) == 0,
+              "INPUT_EVENT_QUEUE_SIZE must be a power of two");
+
+InputEventQueue::InputEventQueue() : head(0), tail(0), dropped(0) {
+}
+
+// Called from IRQ handlers, one of which runs from RAM
+bool __not_in_flash_func(InputEventQueue::push)(uint8_t source, bool pressed, uint32_t time_ms) {
+    uint32_t h = head;
+    if (h - tail >= INPUT_EVENT_QUEUE_SIZE) {
+        dropped = dropped + 1;
+        return false;
+    }
+
+    input_event_t* ev = &events[h & (INPUT_EVENT_QUEUE_SIZE - 1)];
+    ev->source = source;
+    ev->pressed = pressed;
+    ev->time_ms = time_ms;
+    __dmb();  // Event visible before the index moves
+    head = h + 1;
+    return true;
+}
+
+bool InputEventQueue::pop(input_event_t* ev) {
+    uint32_t t = tail;
+    if (t == head) return false;
+
+    __dmb();
+    *ev = events[t & (INPUT_EVENT_QUEUE_SIZE - 1)];
+    __dmb();
+    tail = t + 1;
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef INPUT_EVENT_QUEUE_H
+#define INPUT_EVENT_QUEUE_H
+
+#include <stdint.h>
+
+// Queue depth (power of two). A bouncing trigger can produce a burst of
+// edges between two main-loop passes.
+#define INPUT_EVENT_QUEUE_SIZE  32
+
+enum InputSource {
+    INPUT_TRIGGER,
+    INPUT_BOOTSEL
+};
+
+struct input_event_t {
+    uint8_t source;     // InputSource
+    bool pressed;       // true = press edge, false = release edge
+    uint32_t time_ms;   // When the edge was seen (IRQ / sample time)
+};
+
+// Single-producer/single-consumer ring of button edges. Producers are the
+// trigger GPIO IRQ and the BOOTSEL sampling timer (same core, both IRQ
+// context, so they never interleave with each other); the consumer is
+// the main loop. When full, new edges are dropped and counted.
+class InputEventQueue {
+public:
+    InputEventQueue();
+
+    bool push(uint8_t source, bool pressed, uint32_t time_ms);
+    bool pop(input_event_t* ev);
+
+    bool isEmpty() const { return head == tail; }
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    input_event_t events[INPUT_EVENT_QUEUE_SIZE];
+    volatile uint32_t head;      // Written by producers only
+    volatile uint32_t tail;      // Written by consumer only
+    volatile uint32_t dropped;
+};
+
+#endif // INPUT_EVENT_QUEUE_H
@@ -4,15 +4,29 @@
 #include "hardware/sync.h"
 #include "hardware/structs/ioqspi.h"
 #include "hardware/structs/sio.h"
+#include "hardware/structs/timer.h"
 
-InputHandler::InputHandler() 
-    : last_trigger_time(0),
-      bootsel_pressed(false),
-      bootsel_press_start(0),
-      long_press_triggered(false) {
+// Suspension depth shared by all callers (StateMachine, Settings, ...)
+static volatile int bootsel_suspend_count = 0;
+
+// The GPIO IRQ callback is a plain function; it reaches the single
+// InputHandler through this pointer.
+static InputHandler* input_instance = nullptr;
+
+InputHandler::InputHandler()
+    : seen_dropped(0),
+      last_trigger_edge_ms(0),
+      trigger_pending(false),
+      bootsel(BOOTSEL_SHORT_PRESS_MS, BOOTSEL_LONG_PRESS_MS),
+      bootsel_pending(BUTTON_NONE),
+      bootsel_state(false),
+      bootsel_samples(0),
+      bootsel_irq_off_last_us(0),
+      bootsel_irq_off_max_us(0) {
 }
 
 InputHandler::~InputHandler() {
+    cancel_repeating_timer(&bootsel_timer);
 }
 
 void InputHandler::init() {
@@ -20,31 +34,109 @@ void InputHandler::init() {
     gpio_init(PIN_TRIGGER);
     gpio_set_dir(PIN_TRIGGER, GPIO_IN);
     gpio_pull_up(PIN_TRIGGER);
+
+    input_instance = this;
+    gpio_set_irq_enabled_with_callback(PIN_TRIGGER, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE,
+                                       true, triggerIrqCallback);
+
+    // Negative interval: period measured start-to-start
+    add_repeating_timer_ms(-BOOTSEL_SAMPLE_MS, bootselTimerCallback, this, &bootsel_timer);
 }
 
-bool InputHandler::checkTriggerButton() {
+void InputHandler::setBootselSampleMs(uint32_t ms) {
+    cancel_repeating_timer(&bootsel_timer);
+    add_repeating_timer_ms(-(int32_t)ms, bootselTimerCallback, this, &bootsel_timer);
+}
+
+void InputHandler::suspendBootsel() {
+    uint32_t flags = save_and_disable_interrupts();
+    bootsel_suspend_count = bootsel_suspend_count + 1;
+    restore_interrupts(flags);
+}
+
+void InputHandler::resumeBootsel() {
+    uint32_t flags = save_and_disable_interrupts();
+    if (bootsel_suspend_count > 0) {
+        bootsel_suspend_count = bootsel_suspend_count - 1;
+    }
+    restore_interrupts(flags);
+}
+
+// Timer IRQ context; RAM-resident like the sampler it calls
+bool __no_inline_not_in_flash_func(InputHandler::bootselTimerCallback)(repeating_timer_t* rt) {
+    InputHandler* self = (InputHandler*)rt->user_data;
+    if (bootsel_suspend_count == 0) {
+        bool state = self->getBootselButtonState();
+        self->bootsel_samples = self->bootsel_samples + 1;
+        if (state != self->bootsel_state) {
+            self->bootsel_state = state;
+            self->events.push(INPUT_BOOTSEL, state, to_ms_since_boot(get_absolute_time()));
+        }
+    }
+    return true;
+}
+
+// GPIO IRQ context: record the edge, nothing else
+void InputHandler::triggerIrqCallback(uint gpio, uint32_t event_mask) {
+    if (gpio != PIN_TRIGGER) return;
     uint32_t now = to_ms_since_boot(get_absolute_time());
-    
-    // Check for trigger button press (active low with debounce)
-    if (!gpio_get(PIN_TRIGGER)) {
-        if ((now - last_trigger_time) > TRIGGER_DEBOUNCE_MS) {
-            last_trigger_time = now;
-            return true;
+    if (event_mask & GPIO_IRQ_EDGE_FALL) {
+        input_instance->events.push(INPUT_TRIGGER, true, now);   // Active low
+    }
+    if (event_mask & GPIO_IRQ_EDGE_RISE) {
+        input_instance->events.push(INPUT_TRIGGER, false, now);
+    }
+}
+
+void InputHandler::update(bool accept) {
+    input_event_t ev;
+    while (events.pop(&ev)) {
+        if (ev.source == INPUT_TRIGGER) {
+            // Debounce on timestamps: a press only counts after the line
+            // was quiet for TRIGGER_DEBOUNCE_MS, which also rejects the
+            // falling edges of release bounce
+            uint32_t quiet = ev.time_ms - last_trigger_edge_ms;
+            last_trigger_edge_ms = ev.time_ms;
+            if (ev.pressed && quiet > TRIGGER_DEBOUNCE_MS && accept) {
+                trigger_pending = true;
+            }
+        } else {
+            ButtonEvent e = bootsel.feed(ev.pressed, ev.time_ms);
+            if (e != BUTTON_NONE && accept) {
+                bootsel_pending = e;
+            }
         }
     }
-    return false;
+
+    // Lost edges (queue overflow): resync the press state with the pin
+    if (events.getDropped() != seen_dropped) {
+        seen_dropped = events.getDropped();
+        bootsel.resync(bootsel_state, to_ms_since_boot(get_absolute_time()));
+    }
+
+    if (!accept) {
+        trigger_pending = false;
+        bootsel_pending = BUTTON_NONE;
+    }
+}
+
+bool InputHandler::checkTriggerButton() {
+    bool fired = trigger_pending;
+    trigger_pending = false;
+    return fired;
 }
 
 bool __no_inline_not_in_flash_func(InputHandler::getBootselButtonState)() {
     const uint CS_PIN_INDEX = 1;
 
     uint32_t flags = save_and_disable_interrupts();
+    uint32_t t_start = timer_hw->timerawl;
 
     hw_write_masked(&ioqspi_hw->io[CS_PIN_INDEX].ctrl,
         GPIO_OVERRIDE_LOW << IO_QSPI_GPIO_QSPI_SS_CTRL_OEOVER_LSB,
         IO_QSPI_GPIO_QSPI_SS_CTRL_OEOVER_BITS);
 
-    for (volatile int i = 0; i < 1000; ++i);
+    for (volatile int i = 0; i < BOOTSEL_SETTLE_LOOPS; ++i);
 
 #if PICO_RP2040
     #define CS_BIT (1u << 1)
@@ -57,44 +149,24 @@ bool __no_inline_not_in_flash_func(InputHandler::getBootselButtonState)() {
         GPIO_OVERRIDE_NORMAL << IO_QSPI_GPIO_QSPI_SS_CTRL_OEOVER_LSB,
         IO_QSPI_GPIO_QSPI_SS_CTRL_OEOVER_BITS);
 
+    uint32_t irq_off_us = timer_hw->timerawl - t_start;
     restore_interrupts(flags);
 
+    bootsel_irq_off_last_us = irq_off_us;
+    if (irq_off_us > bootsel_irq_off_max_us) {
+        bootsel_irq_off_max_us = irq_off_us;
+    }
     return button_state;
 }
 
 bool InputHandler::checkBootselButton() {
-    return getBootselButtonState();
+    return bootsel_state;
 }
 
-InputHandler::ButtonEvent InputHandler::getBootselEvent() {
-    bool bootsel_current = checkBootselButton();
-    uint32_t now = to_ms_since_boot(get_absolute_time());
-    ButtonEvent event = BUTTON_NONE;
-    
-    if (bootsel_current && !bootsel_pressed) {
-        // Button just pressed - record start time
-        bootsel_pressed = true;
-        bootsel_press_start = now;
-        long_press_triggered = false;
-    } else if (bootsel_current && bootsel_pressed && !long_press_triggered) {
-        // Button still held - check if we've reached long press threshold
-        if ((now - bootsel_press_start) >= BOOTSEL_LONG_PRESS_MS) {
-            long_press_triggered = true;
-            event = BUTTON_LONG_PRESS;
-        } else {
-            event = BUTTON_HELD;
-        }
-    } else if (!bootsel_current && bootsel_pressed) {
-        // Button just released
-        uint32_t press_duration = now - bootsel_press_start;
-        bootsel_pressed = false;
-        
-        if (!long_press_triggered && press_duration < BOOTSEL_SHORT_PRESS_MS) {
-            event = BUTTON_SHORT_PRESS;
-        }
-        
-        long_press_triggered = false;
-    }
-    
-    return event;
-}
\ No newline at end of file
+ButtonEvent InputHandler::getBootselEvent() {
+    // Completed presses first, then long press / held while still down
+    ButtonEvent event = bootsel_pending;
+    bootsel_pending = BUTTON_NONE;
+    if (event != BUTTON_NONE) return event;
+    return bootsel.poll(to_ms_since_boot(get_absolute_time()));
+}
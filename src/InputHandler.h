@@ -2,6 +2,9 @@
 #define INPUT_HANDLER_H
 
 #include <stdint.h>
+#include "pico/time.h"
+#include "InputEventQueue.h"
+#include "ButtonClassifier.h"
 
 // Pin definitions
 #define PIN_TRIGGER     1   // Active low
@@ -11,38 +14,76 @@
 #define BOOTSEL_SHORT_PRESS_MS  250
 #define BOOTSEL_LONG_PRESS_MS   750
 
+// BOOTSEL sampling. Each sample floats the QSPI CS line with interrupts off,
+// so it runs from RAM in a timer callback at this rate rather than on every
+// main-loop pass. The CS pad gets the same settle loop as the original
+// sampler; the resulting interrupts-off window is timed on every sample
+// and reported by 'D' and 'L' (last and max).
+#define BOOTSEL_SAMPLE_MS       20
+#define BOOTSEL_SETTLE_LOOPS    1000
+
+// Sampling period during low-power idle: the timer is the only periodic
+// wake the application owns. A press that wakes the programmer may start
+// up to this much late, so it reads that much shorter.
+#define BOOTSEL_IDLE_SAMPLE_MS  100
+
+// Buttons are edge-driven: the trigger GPIO IRQ and the BOOTSEL sampling
+// timer push timestamped edges into a queue, and update() classifies them
+// by those timestamps, so press lengths don't depend on main-loop latency.
 class InputHandler {
 public:
     InputHandler();
     ~InputHandler();
-    
+
     void init();
-    
-    // Check for input events
+
+    // Consume queued edges. With accept == false (busy) state is tracked
+    // but presses are discarded instead of piling up for later.
+    void update(bool accept);
+
+    // Check for input events (set by update())
     bool checkTriggerButton();
-    bool checkBootselButton();
-    
-    // Get button states
-    enum ButtonEvent {
-        BUTTON_NONE,
-        BUTTON_SHORT_PRESS,
-        BUTTON_LONG_PRESS,
-        BUTTON_HELD
-    };
-    
+    bool checkBootselButton();   // Raw sampled level
     ButtonEvent getBootselEvent();
-    
+    bool hasPendingEdges() const { return !events.isEmpty(); }  // Safe from any context
+
+    // Pause BOOTSEL sampling around SWIO transfers and RP2040 flash
+    // operations. Calls nest; the last cached state is kept meanwhile.
+    static void suspendBootsel();
+    static void resumeBootsel();
+
+    // Re-arm the BOOTSEL sampling timer with a new period
+    void setBootselSampleMs(uint32_t ms);
+
+    // Diagnostics: samples taken, longest interrupts-off window
+    uint32_t getBootselSampleCount() const { return bootsel_samples; }
+    uint32_t getBootselIrqOffLastUs() const { return bootsel_irq_off_last_us; }
+    uint32_t getBootselIrqOffMaxUs() const { return bootsel_irq_off_max_us; }
+    uint32_t getDroppedEvents() const { return events.getDropped(); }
+
 private:
+    InputEventQueue events;
+    uint32_t seen_dropped;
+
     // Trigger button state
-    uint32_t last_trigger_time;
-    
+    uint32_t last_trigger_edge_ms;
+    bool trigger_pending;
+
     // Bootsel button state
-    bool bootsel_pressed;
-    uint32_t bootsel_press_start;
-    bool long_press_triggered;
-    
-    // Helper function for BOOTSEL
+    ButtonClassifier bootsel;
+    ButtonEvent bootsel_pending;
+
+    // Written by the sampling timer
+    repeating_timer_t bootsel_timer;
+    volatile bool bootsel_state;
+    volatile uint32_t bootsel_samples;
+    volatile uint32_t bootsel_irq_off_last_us;
+    volatile uint32_t bootsel_irq_off_max_us;
+
+    // Helper functions for BOOTSEL
     bool getBootselButtonState();
+    static bool bootselTimerCallback(repeating_timer_t* rt);
+    static void triggerIrqCallback(uint gpio, uint32_t event_mask);
 };
 
 #endif // INPUT_HANDLER_H
\ No newline at end of file
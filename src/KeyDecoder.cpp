@@ -0,0 +1,72 @@
+#include "KeyDecoder.h"
+#include "pico/stdlib.h"
+
+KeyDecoder::KeyDecoder()
+    : state(STATE_IDLE), esc_time_ms(0), pending(KEY_NONE), last_was_cr(false) {
+}
+
+int KeyDecoder::poll() {
+    if (pending != KEY_NONE) {
+        int key = pending;
+        pending = KEY_NONE;
+        return key;
+    }
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    int c = getchar_timeout_us(0);
+    if (c != PICO_ERROR_TIMEOUT) {
+        return feed(c, now);
+    }
+
+    // Nothing new: resolve a stale ESC / truncated sequence
+    if (state != STATE_IDLE && (now - esc_time_ms) >= KEY_ESC_TIMEOUT_MS) {
+        State was = state;
+        state = STATE_IDLE;
+        if (was == STATE_ESC) return KEY_ESCAPE;
+    }
+    return KEY_NONE;
+}
+
+int KeyDecoder::feed(int c, uint32_t now_ms) {
+    switch (state) {
+        case STATE_IDLE:
+            if (c == 0x1B) {
+                state = STATE_ESC;
+                esc_time_ms = now_ms;
+                last_was_cr = false;
+                return KEY_NONE;
+            }
+            if (c == '\n' && last_was_cr) {
+                last_was_cr = false;
+                return KEY_NONE;
+            }
+            last_was_cr = (c == '\r');
+            if (c == '\r' || c == '\n') return KEY_ENTER;
+            return c;
+
+        case STATE_ESC:
+            if (c == '[' || c == 'O') {
+                state = STATE_CSI;
+                return KEY_NONE;
+            }
+            // ESC followed by something else: bare ESC, keep the byte
+            state = STATE_IDLE;
+            pending = feed(c, now_ms);
+            return KEY_ESCAPE;
+
+        case STATE_CSI:
+            // Parameter bytes (e.g. "1;5" in modified arrows) are skipped
+            if ((c >= '0' && c <= '9') || c == ';') {
+                return KEY_NONE;
+            }
+            state = STATE_IDLE;
+            switch (c) {
+                case 'A': return KEY_UP;
+                case 'B': return KEY_DOWN;
+                case 'C': return KEY_RIGHT;
+                case 'D': return KEY_LEFT;
+                default:  return KEY_NONE;
+            }
+    }
+    return KEY_NONE;
+}
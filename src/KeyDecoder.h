@@ -0,0 +1,40 @@
+#ifndef KEY_DECODER_H
+#define KEY_DECODER_H
+
+#include <stdint.h>
+
+// A bare ESC is reported once no further byte arrives within this window
+#define KEY_ESC_TIMEOUT_MS  30
+
+// Key codes returned by KeyDecoder::poll(). Plain characters are returned
+// as themselves; decoded sequences use values outside the byte range.
+enum KeyCode {
+    KEY_NONE   = -1,
+    KEY_ENTER  = '\r',
+    KEY_ESCAPE = 0x1B,
+    KEY_UP     = 0x100,
+    KEY_DOWN,
+    KEY_RIGHT,
+    KEY_LEFT
+};
+
+// Incremental decoder for terminal input. Reads at most one byte per poll()
+// and never waits: ESC sequences are assembled across calls, and a lone ESC
+// is resolved by timestamp instead of blocking for the next byte.
+class KeyDecoder {
+public:
+    KeyDecoder();
+
+    int poll();
+    int feed(int c, uint32_t now_ms);
+
+private:
+    enum State { STATE_IDLE, STATE_ESC, STATE_CSI };
+
+    State state;
+    uint32_t esc_time_ms;
+    int pending;        // Byte that followed a bare ESC, returned next
+    bool last_was_cr;   // Swallow the LF of a CRLF pair
+};
+
+#endif // KEY_DECODER_H
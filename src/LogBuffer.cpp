@@ -0,0 +1,86 @@
+#include "LogBuffer.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/stdio/driver.h"
+#include "pico/stdio_usb.h"
+#include "hardware/sync.h"
+#include "tusb.h"
+
+static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0,
+              "LOG_BUFFER_SIZE must be a power of two");
+
+// The stdio driver callbacks are plain C functions; they reach the single
+// LogBuffer through this pointer.
+static LogBuffer* log_instance = nullptr;
+static stdio_driver_t log_driver;
+
+static void log_out_chars(const char* buf, int len) {
+    log_instance->write(buf, len);
+}
+
+static void log_out_flush() {
+    log_instance->drain();
+}
+
+// Input still comes from USB CDC
+static int log_in_chars(char* buf, int len) {
+    return stdio_usb.in_chars(buf, len);
+}
+
+LogBuffer::LogBuffer() : head(0), tail(0), dropped_bytes(0) {
+}
+
+void LogBuffer::init() {
+    log_instance = this;
+
+    memset(&log_driver, 0, sizeof(log_driver));
+    log_driver.out_chars = log_out_chars;
+    log_driver.out_flush = log_out_flush;
+    log_driver.in_chars = log_in_chars;
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+    log_driver.crlf_enabled = PICO_STDIO_DEFAULT_CRLF;
+#endif
+
+    // Route all stdio through the ring; stdio_usb stays enabled for its
+    // background USB servicing but no longer sees output directly.
+    stdio_set_driver_enabled(&log_driver, true);
+    stdio_filter_driver(&log_driver);
+}
+
+void LogBuffer::write(const char* buf, int len) {
+    uint32_t h = head;
+    uint32_t free_space = LOG_BUFFER_SIZE - (h - tail);
+    if ((uint32_t)len > free_space) {
+        dropped_bytes += len - free_space;
+        len = free_space;
+    }
+
+    for (int i = 0; i < len; i++) {
+        ring[(h + i) & (LOG_BUFFER_SIZE - 1)] = buf[i];
+    }
+    __dmb();  // Data visible before the index moves
+    head = h + len;
+}
+
+void LogBuffer::drain() {
+    if (!stdio_usb_connected()) return;
+
+    // At most two passes: up to the wrap point, then from the start
+    for (int pass = 0; pass < 2; pass++) {
+        uint32_t t = tail;
+        uint32_t used = head - t;
+        if (used == 0) return;
+
+        // Never hand stdio_usb more than fits right now, so it never waits
+        uint32_t room = tud_cdc_write_available();
+        if (room == 0) return;
+        if (used > room) used = room;
+
+        uint32_t pos = t & (LOG_BUFFER_SIZE - 1);
+        if (used > LOG_BUFFER_SIZE - pos) used = LOG_BUFFER_SIZE - pos;
+
+        stdio_usb.out_chars(ring + pos, used);
+        __dmb();
+        tail = t + used;
+    }
+}
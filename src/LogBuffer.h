@@ -0,0 +1,33 @@
+#ifndef LOG_BUFFER_H
+#define LOG_BUFFER_H
+
+#include <stdint.h>
+
+// Ring size (power of two). Large enough for a full display dump.
+#define LOG_BUFFER_SIZE  16384
+
+// Non-blocking stdout. Installs itself as the only stdio output driver, so
+// every printf/printf_g lands in a single-producer/single-consumer ring
+// instead of the USB CDC driver. drain() moves as much as the CDC FIFO can
+// take right now and never waits for the host; when the ring is full new
+// output is dropped and counted.
+class LogBuffer {
+public:
+    LogBuffer();
+
+    void init();
+    void drain();
+
+    uint32_t getDroppedBytes() const { return dropped_bytes; }
+
+    // stdio driver hooks
+    void write(const char* buf, int len);
+
+private:
+    char ring[LOG_BUFFER_SIZE];
+    volatile uint32_t head;      // Written by producer only
+    volatile uint32_t tail;      // Written by consumer only
+    volatile uint32_t dropped_bytes;
+};
+
+#endif // LOG_BUFFER_H
@@ -0,0 +1,133 @@
+#include "LoopMonitor.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "utils.h"
+
+LoopMonitor::LoopMonitor()
+    : budget_us(LOOP_BUDGET_US_DEFAULT),
+      skip_period(false),
+      iter_start_us(0),
+      last_mark_us(0),
+      prev_start_us(0) {
+    memset(current_us, 0, sizeof(current_us));
+    reset();
+}
+
+// Statistics only: reset() is called from inside an iteration ('L'), whose
+// timestamps must survive so it is still charged correctly
+void LoopMonitor::reset() {
+    memset(sections, 0, sizeof(sections));
+    memset(&loop, 0, sizeof(loop));
+    iterations = 0;
+    over_budget = 0;
+    max_period_us = 0;
+}
+
+int LoopMonitor::bucketOf(uint32_t us) {
+    int bucket = 0;
+    while (us > 1 && bucket < LOOP_HIST_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void LoopMonitor::add(section_stats_t* s, uint32_t us) {
+    s->hist[bucketOf(us)]++;
+    s->total_us += us;
+    if (us > s->max_us) s->max_us = us;
+}
+
+void LoopMonitor::begin() {
+    uint32_t now = time_us_32();
+    if (iterations > 0 && !skip_period) {
+        uint32_t period = now - prev_start_us;
+        if (period > max_period_us) max_period_us = period;
+    }
+    skip_period = false;
+    prev_start_us = now;
+    iter_start_us = now;
+    last_mark_us = now;
+    memset(current_us, 0, sizeof(current_us));
+}
+
+void LoopMonitor::mark(LoopSection section) {
+    uint32_t now = time_us_32();
+    current_us[section] += now - last_mark_us;
+    last_mark_us = now;
+}
+
+void LoopMonitor::end() {
+    uint32_t total = time_us_32() - iter_start_us;
+    iterations++;
+
+    LoopSection worst = SECTION_LOG;
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        add(&sections[i], current_us[i]);
+        if (current_us[i] > current_us[worst]) worst = (LoopSection)i;
+    }
+    add(&loop, total);
+
+    if (budget_us && total > budget_us) {
+        over_budget++;
+        printf_g("// LOOP: %luus over %luus budget (%s %luus)\n",
+                 (unsigned long)total, (unsigned long)budget_us,
+                 getSectionName(worst), (unsigned long)current_us[worst]);
+    }
+}
+
+void LoopMonitor::nextBudget() {
+    int next = 0;
+    for (int i = 0; i < LOOP_BUDGET_OPTION_COUNT; i++) {
+        if (LOOP_BUDGET_OPTIONS_US[i] == budget_us) {
+            next = (i + 1) % LOOP_BUDGET_OPTION_COUNT;
+            break;
+        }
+    }
+    budget_us = LOOP_BUDGET_OPTIONS_US[next];
+}
+
+const char* LoopMonitor::getSectionName(LoopSection section) {
+    switch (section) {
+        case SECTION_LOG:      return "log";
+        case SECTION_LED:      return "led";
+        case SECTION_DISPLAY:  return "display";
+        case SECTION_DEBUG:    return "debug";
+        case SECTION_STATE:    return "state";
+        case SECTION_EVENTS:   return "events";
+        case SECTION_INPUT:    return "input";
+        case SECTION_PERSIST:  return "persist";
+        case SECTION_TERMINAL: return "terminal";
+        default:               return "?";
+    }
+}
+
+// One line: max, mean, then non-empty buckets as "<upper bound>:count"
+void LoopMonitor::printHistogram(const char* label, const section_stats_t* s) {
+    uint32_t count = 0;
+    for (int i = 0; i < LOOP_HIST_BUCKETS; i++) count += s->hist[i];
+
+    printf("// %-9s max %7lu  avg %6lu |", label, (unsigned long)s->max_us,
+           (unsigned long)(count ? s->total_us / count : 0));
+    for (int i = 0; i < LOOP_HIST_BUCKETS; i++) {
+        if (!s->hist[i]) continue;
+        if (i == LOOP_HIST_BUCKETS - 1) {
+            printf(" >=%lu:%lu", (unsigned long)(1u << i), (unsigned long)s->hist[i]);
+        } else {
+            printf(" <%lu:%lu", (unsigned long)(2u << i), (unsigned long)s->hist[i]);
+        }
+    }
+    printf("\n");
+}
+
+void LoopMonitor::report() const {
+    printf("// Main loop: %lu iterations, %lu over %luus budget, max period %luus\n",
+           (unsigned long)iterations, (unsigned long)over_budget,
+           (unsigned long)budget_us, (unsigned long)max_period_us);
+    printf("// (times in us; histogram buckets are powers of two)\n");
+    printHistogram("loop", &loop);
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        printHistogram(getSectionName((LoopSection)i), &sections[i]);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef LOOP_MONITOR_H
+#define LOOP_MONITOR_H
+
+#include <stdint.h>
+
+// Iterations whose work (sleep excluded) exceeds this are flagged
+#define LOOP_BUDGET_US_DEFAULT  5000
+
+// Budgets selectable from the terminal ('B' steps through them); 0 = off
+inline constexpr uint32_t LOOP_BUDGET_OPTIONS_US[] = { 1000, 2000, 5000, 10000, 20000, 0 };
+inline constexpr int LOOP_BUDGET_OPTION_COUNT =
+    sizeof(LOOP_BUDGET_OPTIONS_US) / sizeof(LOOP_BUDGET_OPTIONS_US[0]);
+
+// Log2 histogram: bucket i counts durations in [2^i, 2^(i+1)) us,
+// bucket 0 also takes 0 us, the last bucket takes everything above
+#define LOOP_HIST_BUCKETS  20
+
+// Main-loop phases, in loop order
+enum LoopSection {
+    SECTION_LOG,        // log_buffer->drain()
+    SECTION_LED,        // led->update()
+    SECTION_DISPLAY,    // display->update()
+    SECTION_DEBUG,      // GDB remote bridge
+    SECTION_STATE,      // state_machine->process()
+    SECTION_EVENTS,     // State-change handling (beeps)
+    SECTION_INPUT,      // Buttons and serial keys
+    SECTION_PERSIST,    // Settings / stats flash writes
+    SECTION_TERMINAL,   // Terminal redraw
+    SECTION_COUNT
+};
+
+// Lightweight main-loop instrumentation. begin() starts an iteration,
+// mark(section) charges the time since the previous mark to that section,
+// end() closes the iteration. Everything is counters in RAM; report()
+// prints them over serial.
+class LoopMonitor {
+public:
+    LoopMonitor();
+
+    void begin();
+    void mark(LoopSection section);
+    void end();
+
+    // Don't count the gap before the next begin() as a loop period
+    // (the loop was parked in low-power idle)
+    void skipPeriod() { skip_period = true; }
+
+    void setBudgetUs(uint32_t us) { budget_us = us; }
+    uint32_t getBudgetUs() const { return budget_us; }
+    void nextBudget();     // Step through LOOP_BUDGET_OPTIONS_US
+
+    void report() const;
+    void reset();
+
+    static const char* getSectionName(LoopSection section);
+
+private:
+    struct section_stats_t {
+        uint32_t hist[LOOP_HIST_BUCKETS];
+        uint32_t max_us;
+        uint64_t total_us;
+    };
+
+    section_stats_t sections[SECTION_COUNT];
+    section_stats_t loop;           // Whole iteration
+    uint32_t iterations;
+    uint32_t over_budget;
+    uint32_t max_period_us;         // Start-to-start, includes the loop sleep
+    uint32_t budget_us;
+    bool skip_period;
+
+    // Current iteration
+    uint32_t iter_start_us;
+    uint32_t last_mark_us;
+    uint32_t prev_start_us;
+    uint32_t current_us[SECTION_COUNT];
+
+    static int bucketOf(uint32_t us);
+    static void add(section_stats_t* s, uint32_t us);
+    static void printHistogram(const char* label, const section_stats_t* s);
+};
+
+#endif // LOOP_MONITOR_H
@@ -0,0 +1,124 @@
+#include "LowPowerIdle.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/clocks.h"
+#include "hardware/sync.h"
+
+// Peripheral clocks gated while idle. Everything the wake path needs
+// (IO bank, timer, USB, XIP, SRAM, bus fabric) stays on.
+#define IDLE_GATED_EN0 (CLOCKS_WAKE_EN0_CLK_SYS_PIO0_BITS |  \
+                        CLOCKS_WAKE_EN0_CLK_SYS_PIO1_BITS |  \
+                        CLOCKS_WAKE_EN0_CLK_SYS_PWM_BITS |   \
+                        CLOCKS_WAKE_EN0_CLK_SYS_I2C0_BITS |  \
+                        CLOCKS_WAKE_EN0_CLK_SYS_I2C1_BITS |  \
+                        CLOCKS_WAKE_EN0_CLK_SYS_SPI0_BITS |  \
+                        CLOCKS_WAKE_EN0_CLK_PERI_SPI0_BITS | \
+                        CLOCKS_WAKE_EN0_CLK_SYS_SPI1_BITS |  \
+                        CLOCKS_WAKE_EN0_CLK_PERI_SPI1_BITS | \
+                        CLOCKS_WAKE_EN0_CLK_SYS_ADC_BITS |   \
+                        CLOCKS_WAKE_EN0_CLK_ADC_ADC_BITS |   \
+                        CLOCKS_WAKE_EN0_CLK_SYS_RTC_BITS |   \
+                        CLOCKS_WAKE_EN0_CLK_RTC_RTC_BITS |   \
+                        CLOCKS_WAKE_EN0_CLK_SYS_DMA_BITS |   \
+                        CLOCKS_WAKE_EN0_CLK_SYS_JTAG_BITS |  \
+                        CLOCKS_WAKE_EN0_CLK_SYS_PLL_SYS_BITS)
+#define IDLE_GATED_EN1 (CLOCKS_WAKE_EN1_CLK_SYS_UART0_BITS |  \
+                        CLOCKS_WAKE_EN1_CLK_PERI_UART0_BITS | \
+                        CLOCKS_WAKE_EN1_CLK_SYS_UART1_BITS |  \
+                        CLOCKS_WAKE_EN1_CLK_PERI_UART1_BITS)
+
+LowPowerIdle::LowPowerIdle()
+    : timeout_ms(0),
+      last_activity_ms(0),
+      overruns(0),
+      held_off(false),
+      full_khz(0),
+      entries(0),
+      wakeups(0),
+      idle_ms(0),
+      last_resume_us(0),
+      max_resume_us(0),
+      over_budget(0),
+      saved_wake_en0(0),
+      saved_wake_en1(0) {
+}
+
+void LowPowerIdle::noteActivity() {
+    last_activity_ms = to_ms_since_boot(get_absolute_time());
+    held_off = false;
+}
+
+bool LowPowerIdle::isDue() const {
+    if (timeout_ms == 0 || held_off) return false;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    return (now - last_activity_ms) >= timeout_ms;
+}
+
+void LowPowerIdle::enter() {
+    full_khz = clock_get_hz(clk_sys) / 1000;
+
+    // clk_sys and clk_peri onto the USB PLL; stops the system PLL
+    set_sys_clock_48mhz();
+
+    saved_wake_en0 = clocks_hw->wake_en0;
+    saved_wake_en1 = clocks_hw->wake_en1;
+    hw_clear_bits(&clocks_hw->wake_en0, IDLE_GATED_EN0);
+    hw_clear_bits(&clocks_hw->wake_en1, IDLE_GATED_EN1);
+}
+
+void LowPowerIdle::exit() {
+    // Gates first: the PLL registers are among them
+    clocks_hw->wake_en0 = saved_wake_en0;
+    clocks_hw->wake_en1 = saved_wake_en1;
+
+    // Relock the system PLL and move clk_sys/clk_peri back (same dividers
+    // as before, so I2C, PIO and PWM timing needs no reconfiguration)
+    set_sys_clock_khz(full_khz, true);
+}
+
+const char* LowPowerIdle::sleep(const char* (*wake_source)()) {
+    uint32_t start_ms = to_ms_since_boot(get_absolute_time());
+    entries++;
+    enter();
+
+    const char* reason;
+    do {
+        // A wake interrupt arriving after the check stays pending and
+        // makes WFI return at once; its handler runs on restore
+        uint32_t save = save_and_disable_interrupts();
+        reason = wake_source();
+        if (!reason) {
+            __wfi();
+            wakeups++;
+        }
+        restore_interrupts(save);
+    } while (!reason);
+
+    uint32_t exit_us = time_us_32();
+    exit();
+    last_resume_us = time_us_32() - exit_us;
+
+    if (last_resume_us > max_resume_us) max_resume_us = last_resume_us;
+    if (last_resume_us > IDLE_RESUME_BUDGET_US) {
+        over_budget++;
+        if (++overruns >= IDLE_OVERRUN_LIMIT) held_off = true;
+    } else {
+        overruns = 0;
+    }
+
+    // Restart the timeout without re-arming: the wake itself is not
+    // activity, the main loop reports that when the wake is acted on
+    idle_ms += to_ms_since_boot(get_absolute_time()) - start_ms;
+    last_activity_ms = to_ms_since_boot(get_absolute_time());
+    return reason;
+}
+
+void LowPowerIdle::report() const {
+    printf("// Low-power idle: %lu entries, %lu wakeups, %lu s total, resume last %luus "
+           "max %luus, %lu over %uus budget%s\n",
+           (unsigned long)entries, (unsigned long)wakeups, (unsigned long)(idle_ms / 1000),
+           (unsigned long)last_resume_us, (unsigned long)max_resume_us,
+           (unsigned long)over_budget, IDLE_RESUME_BUDGET_US,
+           held_off ? " (idle off)" : "");
+}
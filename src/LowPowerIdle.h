@@ -0,0 +1,66 @@
+#ifndef LOW_POWER_IDLE_H
+#define LOW_POWER_IDLE_H
+
+#include <stdint.h>
+
+// Resume latency bound: exit() alone (system PLL relock and clock switch
+// back), not the waking handler. The PLL normally relocks in well under it.
+// After IDLE_OVERRUN_LIMIT over-budget resumes in a row, idle stays off
+// until the next activity, so one outlier costs nothing.
+#define IDLE_RESUME_BUDGET_US  1000
+#define IDLE_OVERRUN_LIMIT     3
+
+// Low-power idle between units. After the inactivity timeout the main loop
+// parks here instead of spinning: clk_sys moves from the system PLL to the
+// 48 MHz USB PLL (the system PLL is stopped), and the clocks of peripherals
+// nothing uses while idle (PIO/WS2812, PWM/buzzer, I2C/display, SPI, UART,
+// ADC, RTC, DMA, JTAG) are gated. The core then sleeps in WFI; every
+// interrupt (trigger GPIO, BOOTSEL sampling timer, USB and the SDK's USB
+// background task) lets the caller's wake check run, and the first one
+// that reports a reason restores the clocks and returns to the main loop.
+// Wakes that find no reason are counted.
+class LowPowerIdle {
+public:
+    LowPowerIdle();
+
+    // Inactivity timeout; 0 = never idle
+    void setTimeout(uint32_t ms) { timeout_ms = ms; }
+    void noteActivity();            // Also re-arms idle after overruns
+    bool isDue() const;
+
+    // Enter idle, sleep until wake_source() returns a reason (checked with
+    // interrupts masked, so a wake can't slip in before WFI), resume at
+    // full clock. Returns the reason.
+    const char* sleep(const char* (*wake_source)());
+
+    // Diagnostics
+    uint32_t getEntries() const { return entries; }
+    uint32_t getLastResumeUs() const { return last_resume_us; }
+    uint32_t getMaxResumeUs() const { return max_resume_us; }
+    bool isHeldOff() const { return held_off; }
+    void report() const;
+
+private:
+    uint32_t timeout_ms;
+    uint32_t last_activity_ms;
+    uint32_t overruns;              // Over-budget resumes in a row
+    bool held_off;                  // Overrun limit hit, until activity
+    uint32_t full_khz;              // clk_sys to restore
+
+    // Statistics
+    uint32_t entries;
+    uint32_t wakeups;               // WFI returns, including spurious ones
+    uint64_t idle_ms;
+    uint32_t last_resume_us;
+    uint32_t max_resume_us;
+    uint32_t over_budget;
+
+    // Clock gates saved by enter()
+    uint32_t saved_wake_en0;
+    uint32_t saved_wake_en1;
+
+    void enter();
+    void exit();
+};
+
+#endif // LOW_POWER_IDLE_H
@@ -0,0 +1,282 @@
+#include "ProductionStats.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "utils.h"
+#include "Crc32.h"
+#include "FlashLayout.h"
+#include "InputHandler.h"
+
+#define STATS_DELTAS_PER_SECTOR ((FLASH_SECTOR_SIZE - STATS_SNAPSHOT_SIZE) / STATS_DELTA_SIZE)
+
+static_assert(STATS_SNAPSHOT_SIZE % FLASH_PAGE_SIZE == 0, "snapshot must be whole pages");
+static_assert(FLASH_PAGE_SIZE % STATS_DELTA_SIZE == 0, "deltas must not straddle pages");
+static_assert(STATS_DELTAS_PER_SECTOR >= 8, "too few delta slots per sector");
+static_assert(STATS_JOURNAL_SECTORS >= 2, "a new snapshot must not erase the current one");
+
+static uint32_t sectorOffset(int sector) {
+    return STATS_FLASH_OFFSET + sector * FLASH_SECTOR_SIZE;
+}
+
+static const stats_record_t* snapshotAddress(int sector) {
+    return (const stats_record_t*)(XIP_BASE + sectorOffset(sector));
+}
+
+static uint32_t deltaOffset(int sector, int slot) {
+    return sectorOffset(sector) + STATS_SNAPSHOT_SIZE + slot * STATS_DELTA_SIZE;
+}
+
+static const stats_delta_t* deltaAddress(int sector, int slot) {
+    return (const stats_delta_t*)(XIP_BASE + deltaOffset(sector, slot));
+}
+
+static bool deltaIsBlank(int sector, int slot) {
+    const uint32_t* p = (const uint32_t*)(XIP_BASE + deltaOffset(sector, slot));
+    for (size_t i = 0; i < STATS_DELTA_SIZE / sizeof(uint32_t); i++) {
+        if (p[i] != 0xFFFFFFFF) return false;
+    }
+    return true;
+}
+
+ProductionStats::ProductionStats()
+    : dirty(false), sector(-1), next_delta(0), last_change_ms(0) {
+    memset(&data, 0, sizeof(data));
+    memset(pending, 0, sizeof(pending));
+    memset(&pending_unlisted, 0, sizeof(pending_unlisted));
+    data.magic = STATS_MAGIC;
+}
+
+bool ProductionStats::validate(const stats_record_t* r) const {
+    if (r->magic != STATS_MAGIC) return false;
+    return r->crc == Crc32::compute(r, offsetof(stats_record_t, crc));
+}
+
+static bool validateDelta(const stats_delta_t* d) {
+    if (d->magic != STATS_DELTA_MAGIC) return false;
+    return d->crc == Crc32::compute(d, offsetof(stats_delta_t, crc));
+}
+
+void ProductionStats::init() {
+    int newest = -1;
+    for (int s = 0; s < STATS_JOURNAL_SECTORS; s++) {
+        const stats_record_t* rec = snapshotAddress(s);
+        if (!validate(rec)) continue;
+        if (newest < 0 || (int32_t)(rec->sequence - snapshotAddress(newest)->sequence) > 0) {
+            newest = s;
+        }
+    }
+
+    if (newest >= 0) {
+        memcpy(&data, snapshotAddress(newest), sizeof(data));
+        sector = newest;
+
+        // Deltas are appended in order; torn ones are skipped
+        next_delta = 0;
+        int applied = 0;
+        for (int slot = 0; slot < STATS_DELTAS_PER_SECTOR; slot++) {
+            if (deltaIsBlank(newest, slot)) continue;
+            next_delta = slot + 1;
+            const stats_delta_t* d = deltaAddress(newest, slot);
+            if (validateDelta(d) && (int32_t)(d->sequence - data.sequence) > 0) {
+                apply(d);
+                applied++;
+            }
+        }
+        printf_g("// Stats loaded from flash (%lu attempts, %lu passes, %d deltas)\n",
+                 (unsigned long)data.global.attempts, (unsigned long)data.global.passes,
+                 applied);
+    } else {
+        printf_g("// Stats: starting from zero (no valid data in flash)\n");
+    }
+    dirty = false;
+}
+
+uint32_t ProductionStats::nameKey(const char* image_name) {
+    uint32_t key = Crc32::compute(image_name, strlen(image_name));
+    return key ? key : 1;  // 0 marks an unused entry
+}
+
+void ProductionStats::count(stats_counters_t* c, StatsOutcome outcome,
+                            uint32_t bytes, uint32_t duration_ms) {
+    c->attempts++;
+    c->program_time_ms += duration_ms;
+    switch (outcome) {
+        case OUTCOME_PASS:
+            c->passes++;
+            c->bytes_programmed += bytes;
+            break;
+        case OUTCOME_FAIL_DETECT: c->fail_detect++; break;
+        case OUTCOME_FAIL_HALT:   c->fail_halt++;   break;
+        case OUTCOME_FAIL_VERIFY: c->fail_verify++; break;
+        case OUTCOME_FAIL_SETUP:  c->fail_setup++;  break;
+    }
+}
+
+void ProductionStats::add(stats_counters_t* c, const stats_counters_t* d) {
+    c->attempts += d->attempts;
+    c->passes += d->passes;
+    c->fail_detect += d->fail_detect;
+    c->fail_halt += d->fail_halt;
+    c->fail_verify += d->fail_verify;
+    c->fail_setup += d->fail_setup;
+    c->bytes_programmed += d->bytes_programmed;
+    c->program_time_ms += d->program_time_ms;
+}
+
+// Existing entry for key, else the first free one. When the table is full,
+// new images only count towards the global totals.
+stats_entry_t* ProductionStats::entryFor(uint32_t key) {
+    stats_entry_t* entry = nullptr;
+    for (int i = 0; i < STATS_MAX_IMAGES; i++) {
+        if (data.images[i].name_crc == key) return &data.images[i];
+        if (!entry && data.images[i].name_crc == 0) entry = &data.images[i];
+    }
+    if (entry) entry->name_crc = key;
+    return entry;
+}
+
+void ProductionStats::apply(const stats_delta_t* d) {
+    add(&data.global, &d->counters);
+    if (d->name_crc) {
+        stats_entry_t* entry = entryFor(d->name_crc);
+        if (entry) add(&entry->counters, &d->counters);
+    }
+    data.sequence = d->sequence;
+}
+
+void ProductionStats::record(const char* image_name, StatsOutcome outcome,
+                             uint32_t bytes, uint32_t duration_ms) {
+    count(&data.global, outcome, bytes, duration_ms);
+
+    stats_entry_t* entry = entryFor(nameKey(image_name));
+    if (entry) {
+        count(&entry->counters, outcome, bytes, duration_ms);
+        count(&pending[entry - data.images], outcome, bytes, duration_ms);
+    } else {
+        count(&pending_unlisted, outcome, bytes, duration_ms);
+    }
+
+    dirty = true;
+    last_change_ms = to_ms_since_boot(get_absolute_time());
+}
+
+const stats_counters_t* ProductionStats::find(const char* image_name) const {
+    uint32_t key = nameKey(image_name);
+    for (int i = 0; i < STATS_MAX_IMAGES; i++) {
+        if (data.images[i].name_crc == key) return &data.images[i].counters;
+    }
+    return nullptr;
+}
+
+// Callback for flash_safe_execute — runs with interrupts disabled
+struct stats_write_context_t {
+    int32_t erase_offset;  // Sector to erase first, or -1
+    uint32_t offset;
+    const uint8_t* data;
+    size_t len;
+};
+
+static void stats_write_callback(void* param) {
+    stats_write_context_t* ctx = (stats_write_context_t*)param;
+    if (ctx->erase_offset >= 0) {
+        flash_range_erase(ctx->erase_offset, FLASH_SECTOR_SIZE);
+    }
+    flash_range_program(ctx->offset, ctx->data, ctx->len);
+}
+
+static bool stats_write(int32_t erase_offset, uint32_t offset, const uint8_t* data, size_t len) {
+    stats_write_context_t ctx;
+    ctx.erase_offset = erase_offset;
+    ctx.offset = offset;
+    ctx.data = data;
+    ctx.len = len;
+
+    InputHandler::suspendBootsel();  // Sampler must not touch QSPI CS mid-write
+    int rc = flash_safe_execute(stats_write_callback, &ctx, UINT32_MAX);
+    InputHandler::resumeBootsel();
+    if (rc != PICO_OK) {
+        printf_g("// WARNING: Stats checkpoint failed (rc=%d)\n", rc);
+    }
+    return rc == PICO_OK;
+}
+
+// Move the journal to the next sector: erase it and write the whole state.
+// The previous snapshot and its deltas stay valid until this one is.
+bool ProductionStats::writeSnapshot() {
+    int target = (sector + 1) % STATS_JOURNAL_SECTORS;
+
+    data.sequence++;
+    data.crc = Crc32::compute(&data, offsetof(stats_record_t, crc));
+    if (!stats_write(sectorOffset(target), sectorOffset(target),
+                     (const uint8_t*)&data, sizeof(data))) {
+        return false;
+    }
+
+    sector = target;
+    next_delta = 0;
+    memset(pending, 0, sizeof(pending));
+    memset(&pending_unlisted, 0, sizeof(pending_unlisted));
+    return true;
+}
+
+bool ProductionStats::writeDelta(uint32_t key, const stats_counters_t* counters) {
+    stats_delta_t d;
+    memset(&d, 0, sizeof(d));
+    d.magic = STATS_DELTA_MAGIC;
+    d.sequence = data.sequence + 1;
+    d.name_crc = key;
+    d.counters = *counters;
+    d.crc = Crc32::compute(&d, offsetof(stats_delta_t, crc));
+
+    // Program the whole page containing the slot; 0xFF bytes leave the
+    // other slots of that page untouched
+    uint32_t slot_offset = deltaOffset(sector, next_delta);
+    uint32_t page_offset = slot_offset & ~(FLASH_PAGE_SIZE - 1);
+    uint8_t buf[FLASH_PAGE_SIZE];
+    memset(buf, 0xFF, sizeof(buf));
+    memcpy(buf + (slot_offset - page_offset), &d, sizeof(d));
+
+    if (!stats_write(-1, page_offset, buf, sizeof(buf))) {
+        return false;
+    }
+    data.sequence = d.sequence;
+    next_delta++;
+    return true;
+}
+
+void ProductionStats::save() {
+    if (!dirty) return;
+
+    // One delta per changed image; a snapshot when they don't fit (or
+    // there is none yet) covers everything at once
+    int changed = pending_unlisted.attempts ? 1 : 0;
+    for (int i = 0; i < STATS_MAX_IMAGES; i++) {
+        if (pending[i].attempts) changed++;
+    }
+
+    if (sector < 0 || next_delta + changed > STATS_DELTAS_PER_SECTOR) {
+        if (writeSnapshot()) dirty = false;
+        return;
+    }
+
+    for (int i = 0; i < STATS_MAX_IMAGES; i++) {
+        if (!pending[i].attempts) continue;
+        if (!writeDelta(data.images[i].name_crc, &pending[i])) return;
+        memset(&pending[i], 0, sizeof(pending[i]));
+    }
+    if (pending_unlisted.attempts) {
+        if (!writeDelta(0, &pending_unlisted)) return;
+        memset(&pending_unlisted, 0, sizeof(pending_unlisted));
+    }
+    dirty = false;
+}
+
+void ProductionStats::update(bool can_save) {
+    if (!dirty || !can_save) return;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if ((now - last_change_ms) >= STATS_SAVE_DELAY_MS) {
+        save();
+    }
+}
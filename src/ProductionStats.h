@@ -0,0 +1,105 @@
+#ifndef PRODUCTION_STATS_H
+#define PRODUCTION_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define STATS_MAGIC         0x50575354  // "PWST", full snapshot
+#define STATS_DELTA_MAGIC   0x50575344  // "PWSD", one image's increment
+#define STATS_MAX_IMAGES    60          // Per-image slots (keyed by name CRC)
+#define STATS_SNAPSHOT_SIZE 2304        // Snapshot at the start of a journal sector
+#define STATS_DELTA_SIZE    64          // Delta slots fill the rest of the sector
+
+// Checkpoint to flash this long after the last counted cycle (idle only)
+#define STATS_SAVE_DELAY_MS  10000
+
+// Where a programming cycle ended
+enum StatsOutcome {
+    OUTCOME_PASS,
+    OUTCOME_FAIL_DETECT,   // No target answered on SWIO
+    OUTCOME_FAIL_HALT,     // Target found but could not be halted
+    OUTCOME_FAIL_VERIFY,   // Read-back or boot check did not match
+    OUTCOME_FAIL_SETUP     // Programmer side: bad recipe step, invalid
+                           // selection or empty image
+};
+
+struct __attribute__((packed)) stats_counters_t {
+    uint32_t attempts;
+    uint32_t passes;
+    uint32_t fail_detect;
+    uint32_t fail_halt;
+    uint32_t fail_verify;
+    uint32_t fail_setup;
+    uint32_t bytes_programmed;
+    uint32_t program_time_ms;   // Cumulative, CHECKING_TARGET to result
+};                              // = 32 bytes
+
+struct __attribute__((packed)) stats_entry_t {
+    uint32_t name_crc;          // 0 = unused
+    stats_counters_t counters;
+};                              // = 36 bytes
+
+struct __attribute__((packed)) stats_record_t {
+    uint32_t magic;
+    uint32_t sequence;
+    stats_counters_t global;
+    stats_entry_t images[STATS_MAX_IMAGES];
+    uint8_t  _reserved[STATS_SNAPSHOT_SIZE - 8 - 32 - STATS_MAX_IMAGES * 36 - 4];
+    uint32_t crc;
+};
+static_assert(sizeof(stats_record_t) == STATS_SNAPSHOT_SIZE, "stats_record_t layout changed");
+
+// Counts added to one image (name_crc, 0 = global only) since the last
+// checkpoint
+struct __attribute__((packed)) stats_delta_t {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t name_crc;
+    stats_counters_t counters;
+    uint8_t  _reserved[STATS_DELTA_SIZE - 12 - 32 - 4];
+    uint32_t crc;
+};
+static_assert(sizeof(stats_delta_t) == STATS_DELTA_SIZE, "stats_delta_t layout changed");
+
+// Production counters (attempts, passes, failures by phase, bytes, time),
+// global and per image. Kept in RAM and checkpointed to a flash journal.
+// Each journal sector starts with a full snapshot; checkpoints append a
+// small delta per changed image behind it, and only a full sector moves
+// the journal on (erase the next sector, write a new snapshot there).
+// The newest valid snapshot plus the deltas behind it is the state.
+class ProductionStats {
+public:
+    ProductionStats();
+
+    void init();
+    void save();
+    void update(bool can_save);
+    bool isDirty() const { return dirty; }
+
+    void record(const char* image_name, StatsOutcome outcome,
+                uint32_t bytes, uint32_t duration_ms);
+
+    const stats_counters_t& getGlobal() const { return data.global; }
+    const stats_counters_t* find(const char* image_name) const;
+
+private:
+    stats_record_t data;
+    stats_counters_t pending[STATS_MAX_IMAGES];  // Since the last checkpoint
+    stats_counters_t pending_unlisted;           // Images without an entry
+    bool dirty;
+    int sector;                 // Holding the newest snapshot, -1 = none
+    int next_delta;
+    uint32_t last_change_ms;
+
+    static uint32_t nameKey(const char* image_name);
+    static void count(stats_counters_t* c, StatsOutcome outcome,
+                      uint32_t bytes, uint32_t duration_ms);
+    static void add(stats_counters_t* c, const stats_counters_t* d);
+    stats_entry_t* entryFor(uint32_t key);
+    bool validate(const stats_record_t* r) const;
+    void apply(const stats_delta_t* d);
+    bool writeSnapshot();
+    bool writeDelta(uint32_t key, const stats_counters_t* counters);
+};
+
+#endif // PRODUCTION_STATS_H
@@ -0,0 +1,39 @@
+#ifndef RECIPE_H
+#define RECIPE_H
+
+#include <stdint.h>
+
+// Programming recipes: multi-step production sequences declared in
+// firmware.txt ("RECIPE NAME step step ...") and compiled by manifest.cmake
+// into bytecode in firmware_inventory.h. StateMachine runs a recipe inside
+// one debug session, so steps share a single detect/halt/unlock.
+//
+// Bytecode: one opcode byte, followed by operand bytes where noted,
+// terminated by RECIPE_END.
+enum RecipeOp : uint8_t {
+    RECIPE_END = 0,
+    RECIPE_WIPE,        // Mass-erase the target flash
+    RECIPE_FLASH,       // Erase, write and verify an image; operand: firmware_list index
+    RECIPE_UID,         // Read the 96-bit unique ID (ESIG)
+    RECIPE_BOOT,        // Reset and run the target, check the core is running
+    RECIPE_LOG          // Print a production log line (recipe, UID, bytes, time)
+};
+
+// Bytes taken by an instruction (opcode + operands)
+constexpr int recipeOpLength(uint8_t op) {
+    return op == RECIPE_FLASH ? 2 : 1;
+}
+
+struct recipe_info_t {
+    const char* name;
+    const uint8_t* code;
+};
+
+// CH32V003 electronic signature: 96-bit unique ID
+#define TARGET_UID_ADDR     0x1FFFF7E8
+#define TARGET_UID_WORDS    3
+
+// Time the target must keep running after RECIPE_BOOT
+#define RECIPE_BOOT_CHECK_MS  50
+
+#endif // RECIPE_H
@@ -6,12 +6,35 @@
 #include "hardware/flash.h"
 #include "hardware/sync.h"
 #include "utils.h"
+#include "Crc32.h"
+#include "FlashLayout.h"
+#include "InputHandler.h"
+
+// Settings journal in the last sectors of flash (see FlashLayout.h). Each
+// save() appends a record to the next free 32-byte slot; the valid record
+// with the highest sequence number wins. A sector is only erased when the
+// journal wraps into it, and then it only holds records older than the
+// newest one.
+#define SETTINGS_SLOT_SIZE        32
+#define SETTINGS_SLOTS_PER_SECTOR (FLASH_SECTOR_SIZE / SETTINGS_SLOT_SIZE)
+#define SETTINGS_SLOT_COUNT       (SETTINGS_JOURNAL_SECTORS * SETTINGS_SLOTS_PER_SECTOR)
+
+static_assert(sizeof(settings_data_t) <= SETTINGS_SLOT_SIZE, "record exceeds journal slot");
+static_assert(FLASH_PAGE_SIZE % SETTINGS_SLOT_SIZE == 0, "slots must not straddle pages");
+
+static const settings_data_t* slotAddress(int slot) {
+    return (const settings_data_t*)(SETTINGS_FLASH_ADDR + slot * SETTINGS_SLOT_SIZE);
+}
 
-// Settings stored in last sector of flash
-#define SETTINGS_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
-#define SETTINGS_FLASH_ADDR   (XIP_BASE + SETTINGS_FLASH_OFFSET)
+static bool slotIsBlank(int slot) {
+    const uint8_t* p = (const uint8_t*)slotAddress(slot);
+    for (int i = 0; i < SETTINGS_SLOT_SIZE; i++) {
+        if (p[i] != 0xFF) return false;
+    }
+    return true;
+}
 
-Settings::Settings() : dirty(false) {
+Settings::Settings() : dirty(false), next_slot(0), last_change_ms(0) {
     loadDefaults();
 }
 
@@ -25,24 +48,15 @@ void Settings::loadDefaults() {
     data.swio_pin = 8;
     data.sleep_timeout_idx = 3;  // 5 min
     data.last_firmware_idx = 1;
+    data.power_pin = 0;          // No power control
+    data.power_off_ms = SETTINGS_POWER_OFF_MS_DEFAULT;
+    data.power_attach_ms = 0;
     data.crc = calculateCrc(&data);
 }
 
 uint32_t Settings::calculateCrc(const settings_data_t* d) const {
-    // Simple CRC32 over all bytes before the crc field
-    const uint8_t* bytes = (const uint8_t*)d;
-    size_t len = offsetof(settings_data_t, crc);
-    uint32_t crc = 0xFFFFFFFF;
-    for (size_t i = 0; i < len; i++) {
-        crc ^= bytes[i];
-        for (int j = 0; j < 8; j++) {
-            if (crc & 1)
-                crc = (crc >> 1) ^ 0xEDB88320;
-            else
-                crc >>= 1;
-        }
-    }
-    return crc ^ 0xFFFFFFFF;
+    // CRC32 over all bytes before the crc field
+    return Crc32::compute(d, offsetof(settings_data_t, crc));
 }
 
 bool Settings::validate(const settings_data_t* d) const {
@@ -52,18 +66,33 @@ bool Settings::validate(const settings_data_t* d) const {
 }
 
 void Settings::init() {
-    // Read from flash via XIP
-    const settings_data_t* flash_data = (const settings_data_t*)SETTINGS_FLASH_ADDR;
-    if (validate(flash_data)) {
-        memcpy(&data, flash_data, sizeof(data));
+    // Scan the journal via XIP for the newest valid record. A record from
+    // the old single-sector layout sits in slot 0 of the last sector with
+    // sequence 0 and is picked up like any other.
+    int newest = -1;
+    for (int slot = 0; slot < SETTINGS_SLOT_COUNT; slot++) {
+        const settings_data_t* rec = slotAddress(slot);
+        if (!validate(rec)) continue;
+        if (newest < 0 || (int32_t)(rec->sequence - slotAddress(newest)->sequence) > 0) {
+            newest = slot;
+        }
+    }
+
+    if (newest >= 0) {
+        memcpy(&data, slotAddress(newest), sizeof(data));
+        next_slot = (newest + 1) % SETTINGS_SLOT_COUNT;
         // Sanity-check fields to guard against stale/future-version data
         if (data.swio_pin > 29) data.swio_pin = 8;
         if (data.sleep_timeout_idx > 4) data.sleep_timeout_idx = 3;
-        printf_g("// Settings loaded from flash (flip=%d, swio=%d, sleep=%d, fw=%d)\n",
+        // Records from before power control have zeros here
+        if (data.power_pin > 29) data.power_pin = 0;
+        if (data.power_off_ms == 0) data.power_off_ms = SETTINGS_POWER_OFF_MS_DEFAULT;
+        printf_g("// Settings loaded from flash (flip=%d, swio=%d, sleep=%d, fw=%d, i2c=%dkHz, slot=%d)\n",
                  data.display_flip, data.swio_pin, data.sleep_timeout_idx,
-                 data.last_firmware_idx);
+                 data.last_firmware_idx, data.display_i2c_khz, newest);
     } else {
         loadDefaults();
+        next_slot = 0;
         printf_g("// Settings: using defaults (no valid data in flash)\n");
     }
     dirty = false;
@@ -71,6 +100,7 @@ void Settings::init() {
 
 // Callback for flash_safe_execute — runs with interrupts disabled
 struct flash_write_context_t {
+    int32_t erase_offset;  // Sector to erase first, or -1
     uint32_t offset;
     const uint8_t* data;
     size_t len;
@@ -78,58 +108,118 @@ struct flash_write_context_t {
 
 static void flash_write_callback(void* param) {
     flash_write_context_t* ctx = (flash_write_context_t*)param;
-    flash_range_erase(ctx->offset, FLASH_SECTOR_SIZE);
+    if (ctx->erase_offset >= 0) {
+        flash_range_erase(ctx->erase_offset, FLASH_SECTOR_SIZE);
+    }
     flash_range_program(ctx->offset, ctx->data, ctx->len);
 }
 
 void Settings::save() {
     if (!dirty) return;
 
+    data.sequence++;
     data.crc = calculateCrc(&data);
 
-    // Prepare a 256-byte page-aligned buffer
+    // Find the write position. Entering a sector that isn't blank means the
+    // journal has wrapped: that sector only holds records older than the
+    // newest one, so erase it. Non-blank slots inside a sector (torn
+    // writes) are skipped.
+    int slot = next_slot;
+    int32_t erase_offset = -1;
+    while (!slotIsBlank(slot)) {
+        if (slot % SETTINGS_SLOTS_PER_SECTOR == 0) {
+            erase_offset = SETTINGS_FLASH_OFFSET +
+                           (slot / SETTINGS_SLOTS_PER_SECTOR) * FLASH_SECTOR_SIZE;
+            break;
+        }
+        slot = (slot + 1) % SETTINGS_SLOT_COUNT;
+    }
+
+    // Program the whole page containing the slot; 0xFF bytes leave the
+    // other slots of that page untouched
+    uint32_t slot_offset = SETTINGS_FLASH_OFFSET + slot * SETTINGS_SLOT_SIZE;
+    uint32_t page_offset = slot_offset & ~(FLASH_PAGE_SIZE - 1);
     uint8_t buf[FLASH_PAGE_SIZE];
     memset(buf, 0xFF, sizeof(buf));
-    memcpy(buf, &data, sizeof(data));
+    memcpy(buf + (slot_offset - page_offset), &data, sizeof(data));
 
     flash_write_context_t ctx;
-    ctx.offset = SETTINGS_FLASH_OFFSET;
+    ctx.erase_offset = erase_offset;
+    ctx.offset = page_offset;
     ctx.data = buf;
     ctx.len = FLASH_PAGE_SIZE;
 
+    InputHandler::suspendBootsel();  // Sampler must not touch QSPI CS mid-write
     int rc = flash_safe_execute(flash_write_callback, &ctx, UINT32_MAX);
+    InputHandler::resumeBootsel();
     if (rc == PICO_OK) {
         dirty = false;
-        printf_g("// Settings saved to flash\n");
+        next_slot = (slot + 1) % SETTINGS_SLOT_COUNT;
+        printf_g("// Settings saved to flash (slot %d%s)\n", slot,
+                 erase_offset >= 0 ? ", sector erased" : "");
     } else {
         printf_g("// WARNING: Settings save failed (rc=%d)\n", rc);
     }
 }
 
+// Called from the main loop. Changes are coalesced: nothing is written
+// until SETTINGS_SAVE_DELAY_MS after the last change, and only while the
+// caller says flash access can't delay anything (programmer idle).
+void Settings::update(bool can_save) {
+    if (!dirty || !can_save) return;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if ((now - last_change_ms) >= SETTINGS_SAVE_DELAY_MS) {
+        save();
+    }
+}
+
+void Settings::markDirty() {
+    dirty = true;
+    last_change_ms = to_ms_since_boot(get_absolute_time());
+}
+
 void Settings::setDisplayFlip(bool flip) {
     if (data.display_flip != flip) {
         data.display_flip = flip;
-        dirty = true;
+        markDirty();
     }
 }
 
 void Settings::setSwioPin(uint8_t pin) {
     if (data.swio_pin != pin) {
         data.swio_pin = pin;
-        dirty = true;
+        markDirty();
     }
 }
 
 void Settings::setSleepTimeoutIndex(uint16_t idx) {
     if (data.sleep_timeout_idx != idx) {
         data.sleep_timeout_idx = idx;
-        dirty = true;
+        markDirty();
     }
 }
 
 void Settings::setLastFirmwareIndex(int index) {
     if (data.last_firmware_idx != index) {
         data.last_firmware_idx = index;
-        dirty = true;
+        markDirty();
+    }
+}
+
+void Settings::setDisplayI2cKhz(uint16_t khz) {
+    if (data.display_i2c_khz != khz) {
+        data.display_i2c_khz = khz;
+        markDirty();
+    }
+}
+
+void Settings::setPowerControl(uint8_t pin, bool active_low, uint16_t off_ms, uint16_t attach_ms) {
+    if (data.power_pin != pin || data.power_active_low != active_low ||
+        data.power_off_ms != off_ms || data.power_attach_ms != attach_ms) {
+        data.power_pin = pin;
+        data.power_active_low = active_low;
+        data.power_off_ms = off_ms;
+        data.power_attach_ms = attach_ms;
+        markDirty();
     }
 }
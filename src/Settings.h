@@ -12,18 +12,31 @@ struct __attribute__((packed)) settings_data_t {
     uint8_t  swio_pin;           // 1  (GPIO number, default 8)
     uint16_t sleep_timeout_idx;  // 2  (index into timeout table)
     int32_t  last_firmware_idx;  // 4
-    uint8_t  _reserved[12];     // 12
+    uint16_t display_i2c_khz;    // 2  (negotiated display bus rate, 0 = unknown)
+    uint32_t sequence;           // 4  (journal write counter, newest wins)
+    uint8_t  power_pin;          // 1  (target supply switch GPIO, 0 = none)
+    uint8_t  power_active_low;   // 1
+    uint16_t power_off_ms;       // 2  (supply off time of a power cycle)
+    uint16_t power_attach_ms;    // 2  (power-on to attach delay)
     uint32_t crc;                // 4
 };                               // = 28 bytes
 static_assert(sizeof(settings_data_t) == 28, "settings_data_t layout changed");
 
+// Default supply off time of a target power cycle
+#define SETTINGS_POWER_OFF_MS_DEFAULT  200
+
+// Pending changes are committed by update() after this much quiet time
+#define SETTINGS_SAVE_DELAY_MS  2000
+
 class Settings {
 public:
     Settings();
     ~Settings();
 
     void init();
-    void save();
+    void save();                 // Commit now (explicit flush)
+    void update(bool can_save);  // Commit pending changes once quiet
+    bool isDirty() const { return dirty; }
 
     bool getDisplayFlip() const { return data.display_flip; }
     void setDisplayFlip(bool flip);
@@ -37,10 +50,23 @@ public:
     int getLastFirmwareIndex() const { return data.last_firmware_idx; }
     void setLastFirmwareIndex(int index);
 
+    uint16_t getDisplayI2cKhz() const { return data.display_i2c_khz; }
+    void setDisplayI2cKhz(uint16_t khz);
+
+    // Target power control (see TargetPower.h)
+    uint8_t getPowerPin() const { return data.power_pin; }
+    bool getPowerActiveLow() const { return data.power_active_low; }
+    uint16_t getPowerOffMs() const { return data.power_off_ms; }
+    uint16_t getPowerAttachMs() const { return data.power_attach_ms; }
+    void setPowerControl(uint8_t pin, bool active_low, uint16_t off_ms, uint16_t attach_ms);
+
 private:
     settings_data_t data;
     bool dirty;
+    int next_slot;  // Journal slot for the next save()
+    uint32_t last_change_ms;
 
+    void markDirty();
     void loadDefaults();
     uint32_t calculateCrc(const settings_data_t* d) const;
     bool validate(const settings_data_t* d) const;
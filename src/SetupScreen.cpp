@@ -4,14 +4,19 @@
 #include "StateMachine.h"
 #include "PicoSWIO.h"
 #include "RVDebug.h"
+#include "TerminalView.h"
+#include "KeyDecoder.h"
+#include "TargetPower.h"
 #include "pico/stdlib.h"
 #include <stdio.h>
+#include "utils.h"
 
 extern const char* const PROGRAMMER_VERSION;
 
-SetupScreen::SetupScreen()
-    : selected_row(0), edit_display_flip(false),
-      edit_sleep_timeout_idx(3), edit_swio_pin_idx(0) {
+SetupScreen::SetupScreen(TerminalView* terminal_view)
+    : view(terminal_view), selected_row(0), edit_display_flip(false),
+      edit_sleep_timeout_idx(3), edit_swio_pin_idx(0), edit_power_pin_idx(0),
+      edit_power_active_low(false), edit_power_off_idx(1), edit_power_attach_idx(0) {
 }
 
 int SetupScreen::findSwioPinIndex(uint8_t pin) {
@@ -21,6 +26,32 @@ int SetupScreen::findSwioPinIndex(uint8_t pin) {
     return 4;  // default to GPIO 8 (index 4)
 }
 
+int SetupScreen::findPowerPinIndex(uint8_t pin) {
+    for (int i = 0; i < SWIO_PIN_COUNT; i++) {
+        if (SWIO_PIN_OPTIONS[i] == pin) return i + 1;
+    }
+    return 0;  // none
+}
+
+uint8_t SetupScreen::powerPin() const {
+    return edit_power_pin_idx ? SWIO_PIN_OPTIONS[edit_power_pin_idx - 1] : TARGET_POWER_PIN_NONE;
+}
+
+// Index of value in a table, or fallback when it isn't one of the options
+static int findOption(const uint16_t* options, int count, uint16_t value, int fallback) {
+    for (int i = 0; i < count; i++) {
+        if (options[i] == value) return i;
+    }
+    return fallback;
+}
+
+// Step an option index with wrap-around
+static void stepIndex(int* idx, int dir, int count) {
+    *idx += dir;
+    if (*idx < 0) *idx = count - 1;
+    if (*idx >= count) *idx = 0;
+}
+
 void SetupScreen::enter(Settings* settings) {
     selected_row = 0;
     edit_display_flip = settings->getDisplayFlip();
@@ -28,92 +59,119 @@ void SetupScreen::enter(Settings* settings) {
     if (edit_sleep_timeout_idx >= SLEEP_TIMEOUT_COUNT)
         edit_sleep_timeout_idx = 3;
     edit_swio_pin_idx = findSwioPinIndex(settings->getSwioPin());
+    edit_power_pin_idx = findPowerPinIndex(settings->getPowerPin());
+    edit_power_active_low = settings->getPowerActiveLow();
+    edit_power_off_idx = findOption(POWER_OFF_MS_OPTIONS, POWER_OFF_MS_COUNT,
+                                    settings->getPowerOffMs(), 1);
+    edit_power_attach_idx = findOption(POWER_ATTACH_MS_OPTIONS, POWER_ATTACH_MS_COUNT,
+                                       settings->getPowerAttachMs(), 0);
     drawTerminal();
 }
 
 void SetupScreen::drawTerminal() {
-    printf("\033[2J\033[H");  // Clear screen + cursor home
-    printf("//===========================================================\n");
-    printf("//\n");
-    printf("// PewPewCH32 %s SETUP\n", PROGRAMMER_VERSION);
-    printf("//\n");
+    view->begin();
+    view->line("//===========================================================");
+    view->line("//");
+    view->line("// PewPewCH32 %s SETUP", PROGRAMMER_VERSION);
+    view->line("//");
 
     // Row 0: Display orientation
     const char* flip_label = edit_display_flip ? "flipped" : "normal";
-    printf("// %s Display orientation:  < %-8s >\n",
-           (selected_row == 0) ? "-->" : "   ", flip_label);
+    view->line("// %s Display orientation:  < %-8s >",
+               (selected_row == 0) ? "-->" : "   ", flip_label);
 
     // Row 1: Screensaver timeout
-    printf("// %s Screensaver timeout:  < %-8s >\n",
-           (selected_row == 1) ? "-->" : "   ",
-           SLEEP_TIMEOUT_LABELS[edit_sleep_timeout_idx]);
+    view->line("// %s Screensaver timeout:  < %-8s >",
+               (selected_row == 1) ? "-->" : "   ",
+               SLEEP_TIMEOUT_LABELS[edit_sleep_timeout_idx]);
 
     // Row 2: SWIO pin
     char pin_buf[12];
     snprintf(pin_buf, sizeof(pin_buf), "GPIO %d", SWIO_PIN_OPTIONS[edit_swio_pin_idx]);
-    printf("// %s SWIO pin:             < %-8s >\n",
-           (selected_row == 2) ? "-->" : "   ", pin_buf);
-
-    printf("//\n");
-    printf("// [UP/DN] SELECT  [LEFT/RIGHT] CHANGE VALUE\n");
-    printf("// [ENTER] SAVE    [ESC] CANCEL\n");
-    printf("//\n");
-    printf("//===========================================================\n");
+    view->line("// %s SWIO pin:             < %-8s >",
+               (selected_row == 2) ? "-->" : "   ", pin_buf);
+
+    // Row 3-6: Target power control
+    if (edit_power_pin_idx) {
+        snprintf(pin_buf, sizeof(pin_buf), "GPIO %d", powerPin());
+    } else {
+        snprintf(pin_buf, sizeof(pin_buf), "none");
+    }
+    view->line("// %s Target power pin:     < %-8s >",
+               (selected_row == 3) ? "-->" : "   ", pin_buf);
+    view->line("// %s Power pin polarity:   < %-8s >",
+               (selected_row == 4) ? "-->" : "   ",
+               edit_power_active_low ? "low=on" : "high=on");
+    char ms_buf[12];
+    snprintf(ms_buf, sizeof(ms_buf), "%u ms", POWER_OFF_MS_OPTIONS[edit_power_off_idx]);
+    view->line("// %s Power off time:       < %-8s >",
+               (selected_row == 5) ? "-->" : "   ", ms_buf);
+    snprintf(ms_buf, sizeof(ms_buf), "%u ms", POWER_ATTACH_MS_OPTIONS[edit_power_attach_idx]);
+    view->line("// %s Attach delay:         < %-8s >",
+               (selected_row == 6) ? "-->" : "   ", ms_buf);
+
+    view->line("//");
+    view->line("// [UP/DN] SELECT  [LEFT/RIGHT] CHANGE VALUE");
+    view->line("// [ENTER] SAVE    [ESC] CANCEL");
+    view->line("//");
+    view->line("//===========================================================");
+    view->end();
 }
 
-SetupResult SetupScreen::processInput(int c) {
-    // Handle ESC sequences for arrow keys
-    if (c == 0x1B) {
-        // Check for '[' within 10ms — if not, bare ESC = cancel
-        int c2 = getchar_timeout_us(10000);
-        if (c2 != '[') {
-            return RESULT_CANCELLED;
-        }
-        int c3 = getchar_timeout_us(10000);
-        switch (c3) {
-            case 'A':  // UP
-                if (selected_row > 0) selected_row--;
-                drawTerminal();
-                break;
-            case 'B':  // DOWN
-                if (selected_row < NUM_ROWS - 1) selected_row++;
-                drawTerminal();
-                break;
-            case 'C':  // RIGHT — next value
-            case 'D':  // LEFT — previous value
-            {
-                int dir = (c3 == 'C') ? 1 : -1;
-                switch (selected_row) {
-                    case 0:  // Display flip is boolean toggle
-                        edit_display_flip = !edit_display_flip;
-                        break;
-                    case 1:  // Sleep timeout index
-                        edit_sleep_timeout_idx += dir;
-                        if (edit_sleep_timeout_idx < 0)
-                            edit_sleep_timeout_idx = SLEEP_TIMEOUT_COUNT - 1;
-                        if (edit_sleep_timeout_idx >= SLEEP_TIMEOUT_COUNT)
-                            edit_sleep_timeout_idx = 0;
-                        break;
-                    case 2:  // SWIO pin index
-                        edit_swio_pin_idx += dir;
-                        if (edit_swio_pin_idx < 0)
-                            edit_swio_pin_idx = SWIO_PIN_COUNT - 1;
-                        if (edit_swio_pin_idx >= SWIO_PIN_COUNT)
-                            edit_swio_pin_idx = 0;
-                        break;
-                }
-                drawTerminal();
-                break;
+SetupResult SetupScreen::processInput(int key) {
+    switch (key) {
+        case KEY_UP:
+            if (selected_row > 0) selected_row--;
+            drawTerminal();
+            break;
+        case KEY_DOWN:
+            if (selected_row < NUM_ROWS - 1) selected_row++;
+            drawTerminal();
+            break;
+        case KEY_RIGHT:  // next value
+        case KEY_LEFT:   // previous value
+        {
+            int dir = (key == KEY_RIGHT) ? 1 : -1;
+            switch (selected_row) {
+                case 0:  // Display flip is boolean toggle
+                    edit_display_flip = !edit_display_flip;
+                    break;
+                case 1:  // Sleep timeout index
+                    edit_sleep_timeout_idx += dir;
+                    if (edit_sleep_timeout_idx < 0)
+                        edit_sleep_timeout_idx = SLEEP_TIMEOUT_COUNT - 1;
+                    if (edit_sleep_timeout_idx >= SLEEP_TIMEOUT_COUNT)
+                        edit_sleep_timeout_idx = 0;
+                    break;
+                case 2:  // SWIO pin index
+                    edit_swio_pin_idx += dir;
+                    if (edit_swio_pin_idx < 0)
+                        edit_swio_pin_idx = SWIO_PIN_COUNT - 1;
+                    if (edit_swio_pin_idx >= SWIO_PIN_COUNT)
+                        edit_swio_pin_idx = 0;
+                    break;
+                case 3:  // Power pin index (0 = none)
+                    stepIndex(&edit_power_pin_idx, dir, SWIO_PIN_COUNT + 1);
+                    break;
+                case 4:  // Power pin polarity is boolean toggle
+                    edit_power_active_low = !edit_power_active_low;
+                    break;
+                case 5:  // Power off time index
+                    stepIndex(&edit_power_off_idx, dir, POWER_OFF_MS_COUNT);
+                    break;
+                case 6:  // Attach delay index
+                    stepIndex(&edit_power_attach_idx, dir, POWER_ATTACH_MS_COUNT);
+                    break;
             }
-            default:
-                break;
+            drawTerminal();
+            break;
         }
-        return RESULT_PENDING;
-    }
-
-    // ENTER = save
-    if (c == '\r' || c == '\n') {
-        return RESULT_SAVED;
+        case KEY_ESCAPE:
+            return RESULT_CANCELLED;
+        case KEY_ENTER:
+            return RESULT_SAVED;
+        default:
+            break;
     }
 
     return RESULT_PENDING;
@@ -122,12 +180,22 @@ SetupResult SetupScreen::processInput(int c) {
 void SetupScreen::applyToHardware(Settings* settings, DisplayController* display,
                                   PicoSWIO* swio, RVDebug* rvd,
                                   StateMachine* state_machine,
+                                  TargetPower* target_power,
                                   int* swio_pin_out) {
     uint8_t new_pin = SWIO_PIN_OPTIONS[edit_swio_pin_idx];
+    uint8_t power_pin = powerPin();
+    if (power_pin == new_pin) {
+        printf_g("// SETUP power pin GPIO %d is the SWIO pin, power control disabled\n",
+                 power_pin);
+        power_pin = TARGET_POWER_PIN_NONE;
+    }
+    uint16_t off_ms = POWER_OFF_MS_OPTIONS[edit_power_off_idx];
+    uint16_t attach_ms = POWER_ATTACH_MS_OPTIONS[edit_power_attach_idx];
 
     settings->setDisplayFlip(edit_display_flip);
     settings->setSleepTimeoutIndex(edit_sleep_timeout_idx);
     settings->setSwioPin(new_pin);
+    settings->setPowerControl(power_pin, edit_power_active_low, off_ms, attach_ms);
     settings->save();
 
     // Apply display orientation
@@ -136,9 +204,19 @@ void SetupScreen::applyToHardware(Settings* settings, DisplayController* display
     // Apply sleep timeout
     display->setSleepTimeout(SLEEP_TIMEOUT_OPTIONS[edit_sleep_timeout_idx]);
 
+    // A power pin that moves is released before the SWIO change, since the
+    // new SWIO pin may be the old power pin. An unchanged one stays driven
+    // so saving doesn't cut the target's supply.
+    if (target_power->getPin() != power_pin) {
+        target_power->configure(TARGET_POWER_PIN_NONE, false, off_ms, attach_ms);
+    }
+
     // Apply SWIO pin change
     *swio_pin_out = new_pin;
     swio->reset(new_pin);
     rvd->init();
     state_machine->setDebugBus(swio, new_pin);
+
+    // Apply target power control
+    target_power->configure(power_pin, edit_power_active_low, off_ms, attach_ms);
 }
@@ -8,6 +8,8 @@ class DisplayController;
 struct PicoSWIO;
 class RVDebug;
 class StateMachine;
+class TerminalView;
+class TargetPower;
 
 // Sleep timeout options (milliseconds); index 0 = off
 inline constexpr uint32_t SLEEP_TIMEOUT_OPTIONS[] = { 0, 60000, 180000, 300000, 600000 };
@@ -20,6 +22,12 @@ inline constexpr uint8_t SWIO_PIN_OPTIONS[] = {
 };
 inline constexpr int SWIO_PIN_COUNT = sizeof(SWIO_PIN_OPTIONS) / sizeof(SWIO_PIN_OPTIONS[0]);
 
+// Target power control: supply off time and power-on to attach delay (ms)
+inline constexpr uint16_t POWER_OFF_MS_OPTIONS[] = { 100, 200, 500, 1000 };
+inline constexpr int POWER_OFF_MS_COUNT = sizeof(POWER_OFF_MS_OPTIONS) / sizeof(POWER_OFF_MS_OPTIONS[0]);
+inline constexpr uint16_t POWER_ATTACH_MS_OPTIONS[] = { 0, 1, 2, 5, 10, 20, 50 };
+inline constexpr int POWER_ATTACH_MS_COUNT = sizeof(POWER_ATTACH_MS_OPTIONS) / sizeof(POWER_ATTACH_MS_OPTIONS[0]);
+
 enum SetupResult {
     RESULT_PENDING,
     RESULT_SAVED,
@@ -28,24 +36,32 @@ enum SetupResult {
 
 class SetupScreen {
 public:
-    SetupScreen();
+    SetupScreen(TerminalView* terminal_view);
 
     void enter(Settings* settings);
-    SetupResult processInput(int c);
+    SetupResult processInput(int key);  // KeyDecoder key code
     void applyToHardware(Settings* settings, DisplayController* display,
                          PicoSWIO* swio, RVDebug* rvd, StateMachine* state_machine,
-                         int* swio_pin_out);
+                         TargetPower* target_power, int* swio_pin_out);
     void drawTerminal();
 
 private:
-    static const int NUM_ROWS = 3;
+    static const int NUM_ROWS = 7;
+
+    TerminalView* view;
 
     int selected_row;
     bool edit_display_flip;
     int edit_sleep_timeout_idx;
     int edit_swio_pin_idx;
+    int edit_power_pin_idx;      // 0 = none, else SWIO_PIN_OPTIONS[idx - 1]
+    bool edit_power_active_low;
+    int edit_power_off_idx;
+    int edit_power_attach_idx;
 
     int findSwioPinIndex(uint8_t pin);
+    int findPowerPinIndex(uint8_t pin);
+    uint8_t powerPin() const;
 };
 
 #endif // SETUP_SCREEN_H
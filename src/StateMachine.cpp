@@ -1,6 +1,12 @@
 #include "StateMachine.h"
 #include "PicoSWIO.h"
 #include "DisplayController.h"
+#include "LogBuffer.h"
+#include "FirmwareMenu.h"
+#include "Crc32.h"
+#include "InputHandler.h"
+#include "TargetLayout.h"
+#include "TargetPower.h"
 #include <stdio.h>
 #include <string.h>
 #include "pico/stdlib.h"
@@ -18,12 +24,29 @@ StateMachine::StateMachine(LedController* led, RVDebug* rvd, WCHFlash* flash)
       current_firmware_index(0),
       led_controller(led),
       display_controller(nullptr),
+      log_buffer(nullptr),
+      production_stats(nullptr),
+      unit_queue(nullptr),
+      active_record(nullptr),
+      target_power(nullptr),
       rv_debug(rvd),
       debug_swio(nullptr),
       swio_pin(-1),
-      wch_flash(flash) {
-    // Initialize to IDLE state properly (triggers state entry actions)
+      wch_flash(flash),
+      progress_start_ms(0),
+      progress_done(0),
+      progress_total(0),
+      cycle_start_ms(0),
+      last_outcome(OUTCOME_PASS),
+      last_bytes(0),
+      target_uid_valid(false) {
+    // Entry actions need the LED controller running; see init()
     current_state = (SystemState)-1; // Set to invalid state first
+    memset(target_uid, 0, sizeof(target_uid));
+}
+
+void StateMachine::init() {
+    // Initialize to IDLE state properly (triggers state entry actions)
     setState(STATE_IDLE);
 }
 
@@ -61,15 +84,20 @@ void StateMachine::setState(SystemState state) {
             led_controller->startErrorIndication();
             break;
         case STATE_CYCLING_FIRMWARE:
-#ifdef FIRMWARE_INVENTORY_ENABLED
-            if (current_firmware_index == 0) {
-                led_controller->startWipeIndication();
-            } else if (current_firmware_index == 9) {
-                led_controller->startRebootIndication();
-            } else
-#endif
-            {
-                led_controller->startFirmwareIndication(current_firmware_index - 1);
+            switch (FirmwareMenu::kind(current_firmware_index)) {
+                case MENU_WIPE:
+                    led_controller->startWipeIndication();
+                    break;
+                case MENU_REBOOT:
+                    led_controller->startRebootIndication();
+                    break;
+                default:
+                    // Flash count = image number, capped so long catalogues
+                    // don't lock out input while blinking
+                    led_controller->startFirmwareIndication(
+                        current_firmware_index > MENU_MAX_FLASHES
+                            ? MENU_MAX_FLASHES - 1 : current_firmware_index - 1);
+                    break;
             }
             break;
         default:
@@ -87,11 +115,19 @@ void StateMachine::process() {
     
     switch (current_state) {
         case STATE_CHECKING_TARGET:
-            if (haltWithTimeout(100)) {  // 100ms timeout
+            // No BOOTSEL sampling (interrupts off) while SWIO is active
+            InputHandler::suspendBootsel();
+            if (detectTarget()) {
+                InputHandler::resumeBootsel();
                 printf_g("// Target detected - starting programming...\n");
                 setState(STATE_PROGRAMMING);
             } else {
+                InputHandler::resumeBootsel();
                 printf_g("// ERROR: No CH32V003 target detected.\n");
+                recordOutcome(OUTCOME_FAIL_DETECT);
+                last_outcome = OUTCOME_FAIL_DETECT;
+                target_uid_valid = false;
+                reportRecord(false);
                 setState(STATE_ERROR);
             }
             break;
@@ -99,25 +135,41 @@ void StateMachine::process() {
         case STATE_PROGRAMMING:
             {
                 bool success = false;
+                // Failures the target isn't blamed for (invalid selection,
+                // empty image, bad recipe step) count as setup failures;
+                // target-side paths set their own outcome
+                last_outcome = OUTCOME_FAIL_SETUP;
+                last_bytes = 0;
+                target_uid_valid = false;
 
                 // Select firmware to program (or wipe/reboot)
+                InputHandler::suspendBootsel();
 #ifdef FIRMWARE_INVENTORY_ENABLED
-                if (current_firmware_index == 0) {
+                if (!FirmwareMenu::isValid(current_firmware_index)) {
+                    printf_g("// Invalid index\n");
+                } else if (FirmwareMenu::kind(current_firmware_index) == MENU_WIPE) {
                     success = wipeChip();
-                } else if (current_firmware_index == 9) {
+                } else if (FirmwareMenu::kind(current_firmware_index) == MENU_REBOOT) {
                     success = rebootChip();
-                } else if (current_firmware_index <= firmware_count) {
-                    const firmware_info_t* fw = &firmware_list[current_firmware_index - 1];
+                } else if (FirmwareMenu::kind(current_firmware_index) == MENU_RECIPE) {
+                    const recipe_info_t* recipe = FirmwareMenu::recipe(current_firmware_index);
+                    printf_g("// Running recipe: %s\n", recipe->name);
+                    success = runRecipe(recipe);
+                } else {
+                    const firmware_info_t* fw = FirmwareMenu::firmware(current_firmware_index);
                     printf_g("// Programming firmware: %s (@ 0x%08lX)\n",
                              fw->name, (unsigned long)fw->load_addr);
                     success = programFirmware(fw);
-                } else {
-                    printf_g("// Invalid index\n");
                 }
 #else
                 printf_g("// Programming fallback firmware\n");
-                success = programFlash(fallback_firmware, fallback_firmware_size, 0);
+                success = programFlash(fallback_firmware, fallback_firmware_size, 0, 0,
+                                       TargetLayout::lastSector(0, fallback_firmware_size));
 #endif
+                InputHandler::resumeBootsel();
+
+                recordOutcome(success ? OUTCOME_PASS : last_outcome);
+                reportRecord(success);
 
                 if (success) {
                     printf_g("// SUCCESS!\n\n");
@@ -156,67 +208,151 @@ void StateMachine::process() {
 }
 
 void StateMachine::startProgramming() {
-    if (current_state == STATE_IDLE) {
-        setState(STATE_CHECKING_TARGET);
+    if (current_state != STATE_IDLE) {
+        return;
+    }
+
+    // A batch that can't supply this cycle's record refuses it before the
+    // target is touched; no unit was tried, so nothing goes into the stats
+    if (!selectRecord()) {
+        printf_g("// ERROR!\n\n");
+        setState(STATE_ERROR);
+        return;
     }
+
+    cycle_start_ms = to_ms_since_boot(get_absolute_time());
+    setState(STATE_CHECKING_TARGET);
 }
 
 void StateMachine::cycleFirmware() {
-#ifdef FIRMWARE_INVENTORY_ENABLED
-    // Cycle through: [0] WIPE FLASH, [1..firmware_count] firmware entries, [9] REBOOT
-    if (current_firmware_index == 9) {
-        current_firmware_index = 0;
-    } else if (current_firmware_index >= firmware_count) {
-        current_firmware_index = 9;
-    } else {
-        current_firmware_index++;
-    }
-    if (current_firmware_index == 0) {
-        printf_g("// Selected: [0] WIPE FLASH\n");
-    } else if (current_firmware_index == 9) {
-        printf_g("// Selected: [9] REBOOT\n");
-    } else {
-        const firmware_info_t* fw = &firmware_list[current_firmware_index - 1];
-        printf_g("// Firmware selected: [%d] %s\n", current_firmware_index, fw->name);
-    }
-#else
-    current_firmware_index = 0;
-    printf_g("// Firmware selected: [0] fallback\n");
-#endif
+    current_firmware_index = FirmwareMenu::next(current_firmware_index);
+    printf_g("// Selected: [%d] %s\n", current_firmware_index,
+             FirmwareMenu::name(current_firmware_index));
 
     // Notify display
     if (display_controller) {
-        display_controller->setMenuEntry(getCurrentMenuName());
+        display_controller->setMenuEntry(getCurrentMenuName(), current_firmware_index,
+                                         FirmwareMenu::count());
     }
 
     setState(STATE_CYCLING_FIRMWARE);
 }
 
-const char* StateMachine::getStateName(SystemState state) {
-    switch (state) {
-        case STATE_IDLE:             return "READY";
-        case STATE_CHECKING_TARGET:  return "CHECKING...";
-        case STATE_PROGRAMMING:      return "PROGRAMMING...";
-        case STATE_SUCCESS:          return "SUCCESS";
-        case STATE_ERROR:            return "ERROR";
-        case STATE_CYCLING_FIRMWARE: return "SELECTING...";
-        default:                     return "UNKNOWN";
+const char* StateMachine::getCurrentMenuName() const {
+    return FirmwareMenu::name(current_firmware_index);
+}
+
+void StateMachine::recordOutcome(StatsOutcome outcome) {
+    // Wipe and reboot are service actions, not production cycles
+    if (!production_stats || !FirmwareMenu::isProduction(current_firmware_index)) {
+        return;
     }
+
+    uint32_t duration = to_ms_since_boot(get_absolute_time()) - cycle_start_ms;
+    production_stats->record(getCurrentMenuName(), outcome,
+                             outcome == OUTCOME_PASS ? last_bytes : 0, duration);
 }
 
-const char* StateMachine::getCurrentMenuName() const {
+// Pick the unit record for this cycle (at trigger time, so a refusal never
+// reaches the target). Without a batch there is nothing to do; with one,
+// production cycles need a record that fits the selection.
+bool StateMachine::selectRecord() {
+    active_record = nullptr;
+    if (!unit_queue || !unit_queue->isActive() ||
+        !FirmwareMenu::isProduction(current_firmware_index)) {
+        return true;
+    }
+
+    const unit_record_t* record = unit_queue->current();
+    if (!record) {
+        printf_g("// ERROR: Batch exhausted (%d records used)\n", unit_queue->getCount());
+        return false;
+    }
+    if (!recordFits(record)) {
+        printf_g("// ERROR: Record %s (0x%08lX, %d bytes) is outside a patchable area of %s\n",
+                 record->key, (unsigned long)record->addr, record->len, getCurrentMenuName());
+        return false;
+    }
+    printf_g("// Unit record %s: %d bytes at 0x%08lX\n",
+             record->key, record->len, (unsigned long)record->addr);
+    active_record = record;
+    return true;
+}
+
+#ifdef FIRMWARE_INVENTORY_ENABLED
+// A record must lie inside the image; in an XAPP image only in the header's
+// reserved bytes, so both CRCs stay valid
+static bool recordFitsImage(const firmware_info_t* fw, const unit_record_t* record) {
+    uint32_t start = fw->load_addr;
+    uint32_t end = fw->load_addr + fw->size;
+    if (fw->app.valid) {
+        start = fw->load_addr + TARGET_APP_HEADER_FREE;
+        end = fw->load_addr + TARGET_APP_HEADER_SIZE;
+    }
+    return record->addr >= start && record->addr + record->len <= end;
+}
+#endif
+
+bool StateMachine::recordFits(const unit_record_t* record) const {
 #ifdef FIRMWARE_INVENTORY_ENABLED
-    if (current_firmware_index == 0) return "WIPE FLASH";
-    if (current_firmware_index == 9) return "REBOOT";
-    if (current_firmware_index >= 1 && current_firmware_index <= firmware_count) {
-        return firmware_list[current_firmware_index - 1].name;
+    if (FirmwareMenu::kind(current_firmware_index) == MENU_RECIPE) {
+        const recipe_info_t* recipe = FirmwareMenu::recipe(current_firmware_index);
+        for (const uint8_t* pc = recipe->code; *pc != RECIPE_END; pc += recipeOpLength(*pc)) {
+            if (*pc == RECIPE_FLASH && recordFitsImage(&firmware_list[pc[1]], record)) {
+                return true;
+            }
+        }
+        return false;
     }
-    return "???";
+    return recordFitsImage(FirmwareMenu::firmware(current_firmware_index), record);
 #else
-    return "fallback";
+    return record->addr + record->len <= fallback_firmware_size;
 #endif
 }
 
+// Stream the result keyed by record; a passing cycle consumes it
+void StateMachine::reportRecord(bool success) {
+    if (!active_record) return;
+
+    const char* result = "PASS";
+    if (!success) {
+        switch (last_outcome) {
+            case OUTCOME_FAIL_DETECT: result = "FAIL_DETECT"; break;
+            case OUTCOME_FAIL_HALT:   result = "FAIL_HALT"; break;
+            case OUTCOME_FAIL_SETUP:  result = "FAIL_SETUP"; break;
+            default:                  result = "FAIL_VERIFY"; break;
+        }
+    }
+    if (target_uid_valid) {
+        printf_g("// UNIT %s %s uid=%08lX-%08lX-%08lX\n", active_record->key, result,
+                 (unsigned long)target_uid[0], (unsigned long)target_uid[1],
+                 (unsigned long)target_uid[2]);
+    } else {
+        printf_g("// UNIT %s %s\n", active_record->key, result);
+    }
+
+    if (success) {
+        unit_queue->consume();
+    }
+    active_record = nullptr;
+}
+
+// Halt the target; when that fails and a supply switch is fitted, power
+// cycle it and retry right after power-up, before firmware that disables
+// SWIO (or sleeps) gets that far
+bool StateMachine::detectTarget() {
+    if (haltWithTimeout(100)) {  // 100ms timeout
+        return true;
+    }
+    if (!target_power || !target_power->isEnabled()) {
+        return false;
+    }
+
+    printf_g("// Target not responding - power-cycling\n");
+    target_power->cycle();
+    return haltWithTimeout(100);
+}
+
 bool StateMachine::haltWithTimeout(uint32_t timeout_ms) {
     // Re-initialize SWIO bus before each attempt so a freshly connected
     // target receives the reset pulse and config sequence.
@@ -255,27 +391,51 @@ bool StateMachine::haltWithTimeout(uint32_t timeout_ms) {
     }
 }
 
-bool StateMachine::programFlash(const uint8_t* data, size_t size, uint32_t base_address) {
+bool StateMachine::programFlash(const uint8_t* data, size_t size, uint32_t base_address,
+                                uint32_t first_sector, uint32_t last_sector) {
     if (!data || !size) {
         return false;
     }
 
-    printf_g("// Starting flash programming...\n");
-    printf_g("// Firmware size: %d bytes at base 0x%08X\n", size, base_address);
-
     if (!rv_debug->halt()) {
         printf_g("// ERROR: Could not halt target\n");
+        last_outcome = OUTCOME_FAIL_HALT;
         return false;
     }
 
     printf_g("// Unlocking flash...\n");
     wch_flash->unlock_flash();
 
-    // Sector-based erasure: only erase sectors being written
-    // CH32V003 has 1024-byte sectors
-    const uint32_t sector_size = wch_flash->get_sector_size();
-    uint32_t first_sector = base_address / sector_size;
-    uint32_t last_sector = (base_address + size - 1) / sector_size;
+    // Write + verify each count as one unit per byte
+    progress_done = 0;
+    progress_total = ((size + 3) & ~3) * 2;
+    progress_start_ms = to_ms_since_boot(get_absolute_time());
+
+    bool success = writeImage(data, size, base_address, first_sector, last_sector);
+
+    // Always clean up: lock flash and reset target
+    wch_flash->lock_flash();
+    rv_debug->reset();
+    rv_debug->resume();
+
+    return success;
+}
+
+// Erase, write and verify one image. The target must be halted with its
+// flash unlocked; progress continues from progress_done.
+bool StateMachine::writeImage(const uint8_t* data, size_t size, uint32_t base_address,
+                              uint32_t first_sector, uint32_t last_sector) {
+    if (!data || !size) {
+        return false;
+    }
+
+    printf_g("// Starting flash programming...\n");
+    printf_g("// Firmware size: %d bytes at base 0x%08X (crc32 0x%08lX)\n", size, base_address,
+             (unsigned long)Crc32::compute(data, size));
+
+    // Sector-based erasure: only erase sectors being written. The range
+    // comes precomputed with the image (see TargetLayout.h).
+    const uint32_t sector_size = TARGET_SECTOR_SIZE;
 
     printf_g("// Erasing sectors %d to %d...\n", first_sector, last_sector);
     for (uint32_t sector = first_sector; sector <= last_sector; sector++) {
@@ -285,38 +445,92 @@ bool StateMachine::programFlash(const uint8_t* data, size_t size, uint32_t base_
     size_t aligned_size = (size + 3) & ~3;
     printf_g("// Writing %d bytes to flash (aligned to %d)...\n", size, aligned_size);
 
-    uint8_t* aligned_data = (uint8_t*)data;
-    bool need_free = false;
-    if (size != aligned_size) {
-        aligned_data = new uint8_t[aligned_size];
-        memcpy(aligned_data, data, size);
-        memset(aligned_data + size, 0xFF, aligned_size - size);
-        need_free = true;
+    // Write and verify sector by sector so the display can show progress
+    reportProgress(progress_done, progress_total);
+
+    uint32_t offset = 0;
+    while (offset < aligned_size) {
+        uint32_t addr = base_address + offset;
+        uint32_t len = sector_size - (addr % sector_size);
+        if (len > aligned_size - offset) len = aligned_size - offset;
+        wch_flash->write_flash(addr, chunkSource(data, size, base_address, offset, len), len);
+        offset += len;
+        reportProgress(progress_done + offset, progress_total);
     }
 
-    wch_flash->write_flash(base_address, aligned_data, aligned_size);
-
     printf_g("// Verifying flash...\n");
-    bool success = wch_flash->verify_flash(base_address, aligned_data, aligned_size);
-
-    if (need_free) {
-        delete[] aligned_data;
+    bool success = true;
+    offset = 0;
+    while (offset < aligned_size) {
+        uint32_t addr = base_address + offset;
+        uint32_t len = sector_size - (addr % sector_size);
+        if (len > aligned_size - offset) len = aligned_size - offset;
+        if (!wch_flash->verify_flash(addr, chunkSource(data, size, base_address, offset, len), len)) {
+            success = false;
+            break;
+        }
+        offset += len;
+        reportProgress(progress_done + aligned_size + offset, progress_total);
     }
+    progress_done += aligned_size * 2;
 
     if (!success) {
         printf_g("// ERROR: Flash verification failed\n");
+        last_outcome = OUTCOME_FAIL_VERIFY;
     } else {
         printf_g("// Flash programming and verification complete\n");
+        last_bytes += size;
     }
 
-    // Always clean up: lock flash and reset target
-    wch_flash->lock_flash();
-    rv_debug->reset();
-    rv_debug->resume();
-
     return success;
 }
 
+// Source for one write/verify chunk. Chunks inside the image are used in
+// place; the final chunk, which runs past the image into the word padding,
+// is copied into the staging buffer and padded with erased-flash bytes.
+// A chunk covering the active unit record is copied and patched.
+const uint8_t* StateMachine::chunkSource(const uint8_t* data, size_t size, uint32_t base_address,
+                                         uint32_t offset, uint32_t len) {
+    const uint8_t* src = data + offset;
+    if (offset + len > size) {
+        uint32_t valid = size - offset;
+        memcpy(staging, data + offset, valid);
+        memset(staging + valid, 0xFF, len - valid);
+        src = staging;
+    }
+
+    if (active_record) {
+        uint32_t chunk_addr = base_address + offset;
+        uint32_t start = active_record->addr > chunk_addr ? active_record->addr : chunk_addr;
+        uint32_t end = active_record->addr + active_record->len;
+        if (end > chunk_addr + len) end = chunk_addr + len;
+        if (start < end) {
+            if (src != staging) {
+                memcpy(staging, src, len);
+                src = staging;
+            }
+            memcpy(staging + (start - chunk_addr),
+                   active_record->data + (start - active_record->addr), end - start);
+        }
+    }
+    return src;
+}
+
+void StateMachine::reportProgress(uint32_t done, uint32_t total) {
+    // Programming blocks the main loop; keep the log moving meanwhile
+    if (log_buffer) log_buffer->drain();
+
+    if (!display_controller) return;
+
+    // Linear ETA from the rate so far
+    uint32_t eta_ms = UINT32_MAX;
+    if (done > 0) {
+        uint32_t elapsed = to_ms_since_boot(get_absolute_time()) - progress_start_ms;
+        eta_ms = (uint32_t)((uint64_t)elapsed * (total - done) / done);
+    }
+    display_controller->setProgress(done, total, eta_ms);
+}
+
 bool StateMachine::wipeChip() {
     printf_g("// WIPING ENTIRE FLASH\n");
 
@@ -337,6 +551,21 @@ bool StateMachine::wipeChip() {
     return true;
 }
 
+// After reset + resume: the core must still be running (not halted on a
+// trap or lost) once the check time has passed
+bool StateMachine::bootCheck() {
+    sleep_ms(RECIPE_BOOT_CHECK_MS);
+    Reg_DMSTATUS status = rv_debug->get_dmstatus();
+    if (status.raw == 0xFFFFFFFF || status.raw == 0x00000000 ||
+        status.ALLHALTED || !status.ALLRUNNING) {
+        printf_g("// ERROR: Target not running after boot (dmstatus 0x%08lX)\n",
+                 (unsigned long)status.raw);
+        return false;
+    }
+    printf_g("// Target running\n");
+    return true;
+}
+
 bool StateMachine::rebootChip() {
     printf_g("// REBOOTING TARGET\n");
 
@@ -354,6 +583,115 @@ bool StateMachine::programFirmware(const firmware_info_t* fw) {
     }
 
     // Binary is self-contained (header + code), flash at load_addr
-    return programFlash(fw->data, fw->size, fw->load_addr);
+    return programFlash(fw->data, fw->size, fw->load_addr, fw->first_sector, fw->last_sector);
+}
+
+// Interpret a recipe's bytecode in one debug session: the target is halted
+// and its flash unlocked once, on the first step that needs it, and stays
+// so until a boot step or the end of the recipe.
+bool StateMachine::runRecipe(const recipe_info_t* recipe) {
+    if (!recipe) {
+        return false;
+    }
+
+    // One progress bar across all flash steps
+    progress_done = 0;
+    progress_total = 0;
+    for (const uint8_t* pc = recipe->code; *pc != RECIPE_END; pc += recipeOpLength(*pc)) {
+        if (*pc == RECIPE_FLASH) {
+            progress_total += ((firmware_list[pc[1]].size + 3) & ~3) * 2;
+        }
+    }
+    progress_start_ms = to_ms_since_boot(get_absolute_time());
+
+    bool halted = false;
+    bool success = true;
+    int step = 0;
+
+    for (const uint8_t* pc = recipe->code; success && *pc != RECIPE_END;
+         pc += recipeOpLength(*pc)) {
+        uint8_t op = *pc;
+        step++;
+
+        if ((op == RECIPE_WIPE || op == RECIPE_FLASH || op == RECIPE_UID) && !halted) {
+            if (!rv_debug->halt()) {
+                printf_g("// ERROR: Could not halt target\n");
+                last_outcome = OUTCOME_FAIL_HALT;
+                success = false;
+                break;
+            }
+            wch_flash->unlock_flash();
+            halted = true;
+        }
+
+        switch (op) {
+            case RECIPE_WIPE:
+                printf_g("// Step %d: wipe\n", step);
+                wch_flash->wipe_chip();
+                break;
+
+            case RECIPE_FLASH: {
+                const firmware_info_t* fw = &firmware_list[pc[1]];
+                printf_g("// Step %d: flash %s (@ 0x%08lX)\n", step, fw->name,
+                         (unsigned long)fw->load_addr);
+                success = writeImage(fw->data, fw->size, fw->load_addr,
+                                     fw->first_sector, fw->last_sector);
+                break;
+            }
+
+            case RECIPE_UID:
+                for (int i = 0; i < TARGET_UID_WORDS; i++) {
+                    target_uid[i] = rv_debug->get_mem_u32(TARGET_UID_ADDR + 4 * i);
+                }
+                target_uid_valid = true;
+                printf_g("// Step %d: uid %08lX-%08lX-%08lX\n", step,
+                         (unsigned long)target_uid[0], (unsigned long)target_uid[1],
+                         (unsigned long)target_uid[2]);
+                break;
+
+            case RECIPE_BOOT:
+                printf_g("// Step %d: boot check\n", step);
+                if (halted) {
+                    wch_flash->lock_flash();
+                    halted = false;
+                }
+                rv_debug->reset();
+                rv_debug->resume();
+                if (!bootCheck()) {
+                    last_outcome = OUTCOME_FAIL_VERIFY;
+                    success = false;
+                }
+                break;
+
+            case RECIPE_LOG:
+                if (target_uid_valid) {
+                    printf_g("// LOG recipe=%s uid=%08lX-%08lX-%08lX bytes=%lu time=%lums\n",
+                             recipe->name, (unsigned long)target_uid[0],
+                             (unsigned long)target_uid[1], (unsigned long)target_uid[2],
+                             (unsigned long)last_bytes,
+                             (unsigned long)(to_ms_since_boot(get_absolute_time()) - cycle_start_ms));
+                } else {
+                    printf_g("// LOG recipe=%s bytes=%lu time=%lums\n", recipe->name,
+                             (unsigned long)last_bytes,
+                             (unsigned long)(to_ms_since_boot(get_absolute_time()) - cycle_start_ms));
+                }
+                break;
+
+            default:
+                printf_g("// ERROR: Bad recipe opcode %d at step %d\n", op, step);
+                last_outcome = OUTCOME_FAIL_SETUP;
+                success = false;
+                break;
+        }
+    }
+
+    // Leave the target running whatever happened
+    if (halted) {
+        wch_flash->lock_flash();
+        rv_debug->reset();
+        rv_debug->resume();
+    }
+
+    return success;
 }
 #endif
@@ -5,28 +5,31 @@
 #include "LedController.h"
 #include "RVDebug.h"
 #include "WCHFlash.h"
+#include "ProductionStats.h"
+#include "TargetLayout.h"
+#include "Recipe.h"
+#include "UnitQueue.h"
+#include "SystemState.h"
 
 struct PicoSWIO;
 class DisplayController;
+class LogBuffer;
+class TargetPower;
 
 #ifdef FIRMWARE_INVENTORY_ENABLED
   #include "firmware_inventory.h"
 #endif
 
-// System States
-enum SystemState {
-    STATE_IDLE,
-    STATE_CHECKING_TARGET,
-    STATE_PROGRAMMING,
-    STATE_CYCLING_FIRMWARE,
-    STATE_SUCCESS,
-    STATE_ERROR
-};
+// Holds the last, partial chunk of an image padded to a word boundary.
+// Chunks never cross a target sector, so one sector is the upper bound.
+#define STAGING_BUFFER_SIZE  TARGET_SECTOR_SIZE
 
 class StateMachine {
 public:
     StateMachine(LedController* led, RVDebug* rvd, WCHFlash* flash);
     ~StateMachine();
+
+    void init();
     
     // State management
     SystemState getCurrentState() const { return current_state; }
@@ -42,12 +45,16 @@ public:
     // Display integration
     void setDisplayController(DisplayController* dc) { display_controller = dc; }
     void setDebugBus(PicoSWIO* swio, int pin) { debug_swio = swio; swio_pin = pin; }
+    void setLogBuffer(LogBuffer* lb) { log_buffer = lb; }
+    void setProductionStats(ProductionStats* ps) { production_stats = ps; }
+    void setUnitQueue(UnitQueue* uq) { unit_queue = uq; }
+    void setTargetPower(TargetPower* tp) { target_power = tp; }
 
     // Configuration
     void setCurrentFirmwareIndex(int index) { current_firmware_index = index; }
     int getCurrentFirmwareIndex() const { return current_firmware_index; }
     const char* getCurrentMenuName() const;
-    static const char* getStateName(SystemState state);
+    static const char* getStateName(SystemState state) { return systemStateName(state); }
     
 private:
     SystemState current_state;
@@ -56,17 +63,44 @@ private:
     
     LedController* led_controller;
     DisplayController* display_controller;
+    LogBuffer* log_buffer;
+    ProductionStats* production_stats;
+    UnitQueue* unit_queue;
+    const unit_record_t* active_record;     // Patched into this cycle's image
+    TargetPower* target_power;
     RVDebug* rv_debug;
     PicoSWIO* debug_swio;
     int swio_pin;
     WCHFlash* wch_flash;
-    
+    uint32_t progress_start_ms;
+    uint32_t progress_done;         // Work units of earlier images in this cycle
+    uint32_t progress_total;
+    uint32_t cycle_start_ms;        // Trigger accepted (CHECKING_TARGET entry)
+    StatsOutcome last_outcome;      // Set by programFlash()
+    uint32_t last_bytes;
+    uint32_t target_uid[TARGET_UID_WORDS];  // Set by RECIPE_UID
+    bool target_uid_valid;                  // Read during this cycle
+    uint8_t staging[STAGING_BUFFER_SIZE] __attribute__((aligned(4)));
+
     // Helper functions
+    void recordOutcome(StatsOutcome outcome);
+    bool selectRecord();
+    bool recordFits(const unit_record_t* record) const;
+    void reportRecord(bool success);
+    void reportProgress(uint32_t done, uint32_t total);
     bool haltWithTimeout(uint32_t timeout_ms);
+    bool detectTarget();
 #ifdef FIRMWARE_INVENTORY_ENABLED
     bool programFirmware(const firmware_info_t* fw);
+    bool runRecipe(const recipe_info_t* recipe);
 #endif
-    bool programFlash(const uint8_t* data, size_t size, uint32_t base_address);
+    bool programFlash(const uint8_t* data, size_t size, uint32_t base_address,
+                      uint32_t first_sector, uint32_t last_sector);
+    bool writeImage(const uint8_t* data, size_t size, uint32_t base_address,
+                    uint32_t first_sector, uint32_t last_sector);
+    bool bootCheck();
+    const uint8_t* chunkSource(const uint8_t* data, size_t size, uint32_t base_address,
+                               uint32_t offset, uint32_t len);
     bool wipeChip();
     bool rebootChip();
 };
@@ -0,0 +1,27 @@
+#ifndef SYSTEM_STATE_H
+#define SYSTEM_STATE_H
+
+// System States (kept apart from StateMachine.h so the display code
+// builds without the debug stack, e.g. in the host render harness)
+enum SystemState {
+    STATE_IDLE,
+    STATE_CHECKING_TARGET,
+    STATE_PROGRAMMING,
+    STATE_CYCLING_FIRMWARE,
+    STATE_SUCCESS,
+    STATE_ERROR
+};
+
+inline const char* systemStateName(SystemState state) {
+    switch (state) {
+        case STATE_IDLE:             return "READY";
+        case STATE_CHECKING_TARGET:  return "CHECKING...";
+        case STATE_PROGRAMMING:      return "PROGRAMMING...";
+        case STATE_SUCCESS:          return "SUCCESS";
+        case STATE_ERROR:            return "ERROR";
+        case STATE_CYCLING_FIRMWARE: return "SELECTING...";
+        default:                     return "UNKNOWN";
+    }
+}
+
+#endif // SYSTEM_STATE_H
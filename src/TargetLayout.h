@@ -0,0 +1,57 @@
+#ifndef TARGET_LAYOUT_H
+#define TARGET_LAYOUT_H
+
+#include <stdint.h>
+
+// CH32V003 code flash geometry, as offsets from the start of code flash
+// (the addresses used in firmware.txt and by WCHFlash)
+#define TARGET_FLASH_SIZE       (16 * 1024)
+#define TARGET_SECTOR_SIZE      1024    // Erase unit
+#define TARGET_PAGE_SIZE        64      // Fast-programming unit
+
+// Boot-state page between bootloader and application (the application
+// header follows at 0x1040). Images must not write into it. It shares
+// sector 4 with the application start, so flashing an application erases
+// it: intended, a fresh application starts without a stale update request.
+#define TARGET_BOOT_STATE_ADDR  0x1000
+#define TARGET_BOOT_STATE_SIZE  TARGET_PAGE_SIZE
+
+// Application (XAPP) header at the start of app images. Its reserved bytes,
+// from TARGET_APP_HEADER_FREE to the end, are covered by neither the header
+// CRC nor the application CRC, so per-unit data can be patched in there.
+#define TARGET_APP_HEADER_SIZE  64
+#define TARGET_APP_HEADER_FREE  24
+
+// Compile-time layout arithmetic for the generated firmware inventory
+// (firmware_inventory.h): derived constants and the checks behind its
+// static_asserts.
+struct TargetLayout {
+    static constexpr uint32_t firstSector(uint32_t addr) {
+        return addr / TARGET_SECTOR_SIZE;
+    }
+    static constexpr uint32_t lastSector(uint32_t addr, uint32_t size) {
+        return (addr + size - 1) / TARGET_SECTOR_SIZE;
+    }
+
+    static constexpr bool overlaps(uint32_t a_addr, uint32_t a_size,
+                                   uint32_t b_addr, uint32_t b_size) {
+        return a_addr < b_addr + b_size && b_addr < a_addr + a_size;
+    }
+    // Writing an image erases every sector it touches, so images written
+    // in one session must not even share a sector
+    static constexpr bool sharesSector(uint32_t a_first, uint32_t a_last,
+                                       uint32_t b_first, uint32_t b_last) {
+        return a_first <= b_last && b_first <= a_last;
+    }
+    static constexpr bool fitsFlash(uint32_t addr, uint32_t size) {
+        return size > 0 && addr < TARGET_FLASH_SIZE && size <= TARGET_FLASH_SIZE - addr;
+    }
+    static constexpr bool avoidsBootState(uint32_t addr, uint32_t size) {
+        return !overlaps(addr, size, TARGET_BOOT_STATE_ADDR, TARGET_BOOT_STATE_SIZE);
+    }
+    static constexpr bool wordAligned(uint32_t addr) {
+        return (addr & 3) == 0;
+    }
+};
+
+#endif // TARGET_LAYOUT_H
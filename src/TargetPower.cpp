@@ -0,0 +1,54 @@
+#include "TargetPower.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+
+TargetPower::TargetPower()
+    : pin(TARGET_POWER_PIN_NONE),
+      active_low(false),
+      off_ms(0),
+      attach_delay_ms(0),
+      cycles(0) {
+}
+
+void TargetPower::configure(uint8_t new_pin, bool new_active_low,
+                            uint32_t new_off_ms, uint32_t new_attach_delay_ms) {
+    bool same_pin = (new_pin == pin);
+    if (pin != TARGET_POWER_PIN_NONE && !same_pin) {
+        gpio_deinit(pin);
+    }
+
+    pin = new_pin;
+    active_low = new_active_low;
+    off_ms = new_off_ms;
+    attach_delay_ms = new_attach_delay_ms;
+
+    if (pin == TARGET_POWER_PIN_NONE) return;
+
+    if (same_pin) {
+        // Already an output: gpio_init() would float it for a moment
+        setPowered(true);
+        return;
+    }
+
+    // Set the level before enabling the output so the target stays powered
+    gpio_init(pin);
+    setPowered(true);
+    gpio_set_dir(pin, GPIO_OUT);
+}
+
+void TargetPower::setPowered(bool on) {
+    if (pin == TARGET_POWER_PIN_NONE) return;
+    gpio_put(pin, on != active_low);
+}
+
+void TargetPower::cycle() {
+    if (pin == TARGET_POWER_PIN_NONE) return;
+
+    setPowered(false);
+    sleep_ms(off_ms);
+    setPowered(true);
+    if (attach_delay_ms) {
+        sleep_ms(attach_delay_ms);
+    }
+    cycles++;
+}
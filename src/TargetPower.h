@@ -0,0 +1,40 @@
+#ifndef TARGET_POWER_H
+#define TARGET_POWER_H
+
+#include <stdint.h>
+
+// Value of the power pin setting meaning "no power control" (GPIO0 is the
+// buzzer, so it can never be a power switch)
+#define TARGET_POWER_PIN_NONE  0
+
+// Optional target supply switch (MOSFET) on a GPIO. A target whose firmware
+// disables SWIO or sleeps can't be halted; cutting its supply and attaching
+// right after power-up, before the firmware reaches that point, recovers it
+// without a manual re-seat.
+class TargetPower {
+public:
+    TargetPower();
+
+    // Takes over the pin (releasing the previous one) and powers the target.
+    // Reconfiguring the current pin keeps it driven.
+    void configure(uint8_t pin, bool active_low, uint32_t off_ms, uint32_t attach_delay_ms);
+
+    bool isEnabled() const { return pin != TARGET_POWER_PIN_NONE; }
+    uint8_t getPin() const { return pin; }
+    void setPowered(bool on);
+
+    // Off for off_ms, on, then wait attach_delay_ms: returns at the start
+    // of the early-boot attach window
+    void cycle();
+
+    uint32_t getCycleCount() const { return cycles; }
+
+private:
+    uint8_t pin;
+    bool active_low;
+    uint32_t off_ms;
+    uint32_t attach_delay_ms;
+    uint32_t cycles;
+};
+
+#endif // TARGET_POWER_H
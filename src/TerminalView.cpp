@@ -0,0 +1,60 @@
+#include "TerminalView.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+static_assert(TERM_MAX_LINES <= 32, "dirty mask is 32 bits");
+
+TerminalView::TerminalView()
+    : line_count(0), pending_count(0), dirty(0), full_redraw(true) {
+    memset(lines, 0, sizeof(lines));
+}
+
+void TerminalView::begin() {
+    pending_count = 0;
+    dirty = 0;
+}
+
+void TerminalView::line(const char* fmt, ...) {
+    if (pending_count >= TERM_MAX_LINES) return;
+
+    char buf[TERM_LINE_LEN + 1];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    // Compare against what the terminal already shows
+    char* cached = lines[pending_count];
+    if (pending_count >= line_count || strcmp(cached, buf) != 0) {
+        strcpy(cached, buf);
+        dirty |= (1u << pending_count);
+    }
+    pending_count++;
+}
+
+void TerminalView::end() {
+    if (full_redraw || pending_count != line_count) {
+        // Reset scroll region, clear screen + cursor home, print everything
+        printf("\033[r\033[2J\033[H");
+        for (int i = 0; i < pending_count; i++) {
+            printf("%s\n", lines[i]);
+        }
+        // Pin the UI: scroll region starts below it, then park the cursor there
+        printf("\033[%dr\033[%d;1H", pending_count + 1, pending_count + 1);
+        line_count = pending_count;
+        full_redraw = false;
+        return;
+    }
+
+    if (!dirty) return;
+
+    // Save cursor, rewrite changed lines in place, restore cursor
+    printf("\0337");
+    for (int i = 0; i < line_count; i++) {
+        if (dirty & (1u << i)) {
+            printf("\033[%d;1H%s\033[K", i + 1, lines[i]);
+        }
+    }
+    printf("\0338");
+}
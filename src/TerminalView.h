@@ -0,0 +1,34 @@
+#ifndef TERMINAL_VIEW_H
+#define TERMINAL_VIEW_H
+
+#include <stdint.h>
+
+// Terminal geometry handled by the view
+#define TERM_MAX_LINES  32
+#define TERM_LINE_LEN   80
+
+// Line-based model of the ANSI terminal UI. A screen is described each time
+// as a sequence of line() calls between begin() and end(); end() only sends
+// the lines that differ from what is already on the terminal, using cursor
+// positioning. The UI rows are pinned above a scroll region, so log output
+// (printf_g) scrolls underneath without disturbing them.
+class TerminalView {
+public:
+    TerminalView();
+
+    void begin();
+    void line(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    void end();
+
+    // Force a full repaint on the next end() (screen switch, manual refresh)
+    void invalidate() { full_redraw = true; }
+
+private:
+    char lines[TERM_MAX_LINES][TERM_LINE_LEN + 1];
+    int line_count;      // Lines currently on the terminal
+    int pending_count;   // Lines described since begin()
+    uint32_t dirty;      // Bit per line that changed since begin()
+    bool full_redraw;
+};
+
+#endif // TERMINAL_VIEW_H
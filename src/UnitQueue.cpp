@@ -0,0 +1,79 @@
+#include "UnitQueue.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+UnitQueue::UnitQueue() : count(0), head(0) {
+}
+
+void UnitQueue::begin() {
+    clear();
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = (char)tolower((unsigned char)c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool UnitQueue::addLine(const char* line, const char** error) {
+    if (count >= UNIT_QUEUE_SIZE) {
+        *error = "queue full";
+        return false;
+    }
+    unit_record_t* r = &records[count];
+
+    // Key
+    while (*line == ' ') line++;
+    int n = 0;
+    while (*line && *line != ' ') {
+        if (n == UNIT_KEY_LEN) {
+            *error = "key too long";
+            return false;
+        }
+        r->key[n++] = *line++;
+    }
+    r->key[n] = '\0';
+    if (n == 0) {
+        *error = "missing key";
+        return false;
+    }
+
+    // Target address
+    char* end;
+    r->addr = strtoul(line, &end, 0);
+    if (end == line) {
+        *error = "missing address";
+        return false;
+    }
+    line = end;
+
+    // Patch bytes: hex pairs, spaces between bytes optional
+    r->len = 0;
+    while (*line) {
+        if (*line == ' ') {
+            line++;
+            continue;
+        }
+        int hi = hexValue(line[0]);
+        int lo = hexValue(line[1]);
+        if (hi < 0 || lo < 0) {
+            *error = "bad hex data";
+            return false;
+        }
+        if (r->len == UNIT_DATA_MAX) {
+            *error = "data too long";
+            return false;
+        }
+        r->data[r->len++] = (uint8_t)(hi << 4 | lo);
+        line += 2;
+    }
+    if (r->len == 0) {
+        *error = "missing data";
+        return false;
+    }
+
+    count++;
+    return true;
+}
@@ -0,0 +1,51 @@
+#ifndef UNIT_QUEUE_H
+#define UNIT_QUEUE_H
+
+#include <stdint.h>
+
+// Queue capacity (records) and per-record limits
+#define UNIT_QUEUE_SIZE      256
+#define UNIT_KEY_LEN         16     // Record key (serial number, order line, ...)
+#define UNIT_DATA_MAX        32     // Patch bytes per record
+
+// One per-unit record: bytes to patch into the programmed image at a
+// target flash address, identified by a host-chosen key
+struct unit_record_t {
+    char key[UNIT_KEY_LEN + 1];
+    uint32_t addr;
+    uint8_t len;
+    uint8_t data[UNIT_DATA_MAX];
+};
+
+// Batch of per-unit records uploaded by the fixture PC in one go (RAM only;
+// a reset drops the batch). Each passing program cycle consumes the head
+// record; a failed cycle keeps it for the next unit. While a batch is
+// loaded, cycles without a record (batch exhausted) are refused.
+//
+// Upload is line based: "KEY ADDR HEX" per record, e.g.
+//   SN000123 0x1058 53 4E 30 30 30 31 32 33
+// (hex bytes may also be written without spaces), "." ends the batch.
+class UnitQueue {
+public:
+    UnitQueue();
+
+    // Upload: begin() drops any previous batch, addLine() parses one line
+    // (false with the reason in *error on a bad record)
+    void begin();
+    bool addLine(const char* line, const char** error);
+
+    void clear() { count = 0; head = 0; }
+    bool isActive() const { return count > 0; }
+    const unit_record_t* current() const { return head < count ? &records[head] : nullptr; }
+    void consume() { if (head < count) head++; }
+
+    int getCount() const { return count; }
+    int getRemaining() const { return count - head; }
+
+private:
+    unit_record_t records[UNIT_QUEUE_SIZE];
+    int count;
+    int head;
+};
+
+#endif // UNIT_QUEUE_H
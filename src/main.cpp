@@ -11,6 +11,18 @@
 #include "Settings.h"
 #include "DisplayController.h"
 #include "SetupScreen.h"
+#include "TerminalView.h"
+#include "LogBuffer.h"
+#include "KeyDecoder.h"
+#include "FirmwareMenu.h"
+#include "Crc32.h"
+#include "ProductionStats.h"
+#include "LoopMonitor.h"
+#include "TargetLayout.h"
+#include "GdbBridge.h"
+#include "UnitQueue.h"
+#include "TargetPower.h"
+#include "LowPowerIdle.h"
 
 // Debug modules
 #include "PicoSWIO.h"
@@ -28,7 +40,6 @@
 
 static int swio_pin = 8;   // To SDI on CH32, loaded from settings
 
-const int ch32v003_flash_size = 16*1024;
 extern const char* const PROGRAMMER_VERSION = "1.2.0";
 
 // Fallback firmware if no external firmware repositories are available
@@ -40,72 +51,364 @@ const uint8_t fallback_firmware[] = {
 };
 const size_t fallback_firmware_size = sizeof(fallback_firmware);
 
+// All long-lived objects are statically allocated, so nothing touches the
+// heap after boot and each module's footprint shows up in the RAM map.
+// Constructors only store pointers / clear state; hardware setup happens
+// in the init() calls in main(), in the original order.
+static LogBuffer         log_buffer_obj;
+static Settings          settings_obj;
+static DisplayController display_obj;
+static ProductionStats   production_stats_obj;
+static LedController     led_obj;
+static BuzzerController  buzzer_obj;
+static InputHandler      input_obj;
+static PicoSWIO          swio_obj;
+static RVDebug           rvd_obj(&swio_obj, 16);
+static WCHFlash          flash_obj(&rvd_obj, TARGET_FLASH_SIZE);
+static SoftBreak         soft_obj(&rvd_obj, &flash_obj);
+static GDBServer         gdb_obj(&rvd_obj, &flash_obj, &soft_obj);
+static Console           console_obj(&rvd_obj, &flash_obj, &soft_obj);
+static StateMachine      state_machine_obj(&led_obj, &rvd_obj, &flash_obj);
+static TerminalView      terminal_view_obj;
+static KeyDecoder        keys_obj;
+static SetupScreen       setup_screen_obj(&terminal_view_obj);
+static LoopMonitor       loop_monitor_obj;
+static GdbBridge         gdb_bridge_obj(&gdb_obj);
+static UnitQueue         unit_queue_obj;
+static TargetPower       target_power_obj;
+static LowPowerIdle      low_power_idle_obj;
+
 // Global pointers for terminal UI redraw
-static StateMachine* g_state_machine = nullptr;
-static SetupScreen* setup_screen = nullptr;
+static StateMachine* const g_state_machine = &state_machine_obj;
+static SetupScreen* const setup_screen = &setup_screen_obj;
 static bool in_setup_mode = false;
+static TerminalView* const terminal_view = &terminal_view_obj;
+static LogBuffer* const log_buffer = &log_buffer_obj;
+static KeyDecoder* const keys = &keys_obj;
+static ProductionStats* const production_stats = &production_stats_obj;
+static bool show_stats = false;
+static GdbBridge* const gdb_bridge = &gdb_bridge_obj;
+static bool in_console_mode = false;
+static UnitQueue* const unit_queue = &unit_queue_obj;
+static TargetPower* const target_power = &target_power_obj;
+static LowPowerIdle* const low_power_idle = &low_power_idle_obj;
+
+// USB state when low-power idle was entered; a change wakes
+static bool idle_usb_mounted = false;
+static bool idle_usb_connected = false;
+
+// Batch upload ('Q'): one record per line, "." ends
+#define UPLOAD_LINE_MAX  128
+static bool in_upload = false;
+static char upload_line[UPLOAD_LINE_MAX + 1];
+static int upload_len = 0;
+static bool upload_overflow = false;   // Current line lost characters
+static int upload_line_no = 0;
+static int upload_errors = 0;
+
+// Quick-select state: multi-digit number entry and name-prefix search
+#define QUICK_SELECT_TIMEOUT_MS  1000
+#define SEARCH_MAX_LEN           16
+static int quick_number = -1;          // Digits typed so far, -1 = none
+static uint32_t quick_number_ms = 0;   // Time of the last digit
+static bool in_search = false;
+static char search_buf[SEARCH_MAX_LEN + 1];
+static int search_len = 0;
+
+// One dashboard line: attempts, yield, failures by phase, mean cycle time
+static void statsLine(TerminalView* view, const char* label, const stats_counters_t* c) {
+    if (!c || c->attempts == 0) {
+        view->line("// %-20.20s      -", label);
+        return;
+    }
+    view->line("// %-20.20s %6lu %3lu%%  det %lu halt %lu ver %lu set %lu  %lums",
+               label, (unsigned long)c->attempts,
+               (unsigned long)((uint64_t)c->passes * 100 / c->attempts),
+               (unsigned long)c->fail_detect, (unsigned long)c->fail_halt,
+               (unsigned long)c->fail_verify, (unsigned long)c->fail_setup,
+               (unsigned long)(c->program_time_ms / c->attempts));
+}
+
+// Production dashboard: totals plus the images on the current menu page
+static void drawStatsUI() {
+    TerminalView* view = terminal_view;
+    view->begin();
+    view->line("//===========================================================");
+    view->line("//");
+    view->line("// PewPewCH32 %s - production stats", PROGRAMMER_VERSION);
+    view->line("//");
+    view->line("// %-20s %6s %4s  %-25s %s", "Image", "Tries", "Yld", "Failures", "Avg");
+    statsLine(view, "ALL IMAGES", &production_stats->getGlobal());
+    view->line("//");
+
+    int first = FirmwareMenu::pageStart(FirmwareMenu::pageOf(g_state_machine->getCurrentFirmwareIndex()));
+    for (int i = first; i < first + MENU_PAGE_SIZE && i < FirmwareMenu::count(); i++) {
+        if (!FirmwareMenu::isProduction(i)) continue;
+        statsLine(view, FirmwareMenu::name(i), production_stats->find(FirmwareMenu::name(i)));
+    }
+
+    view->line("//");
+    view->line("// Total programmed: %lu bytes",
+               (unsigned long)production_stats->getGlobal().bytes_programmed);
+    view->line("// [T] BACK  [LT/RT] PAGE");
+    view->line("//===========================================================");
+    view->end();
+}
 
-// Draw the full terminal UI (replaces print_header + list_firmware)
+// GDB remote mode: connection status and traffic on the second port
+static void drawGdbUI() {
+    TerminalView* view = terminal_view;
+    view->begin();
+    view->line("//===========================================================");
+    view->line("//");
+    view->line("// PewPewCH32 %s - GDB remote", PROGRAMMER_VERSION);
+    view->line("//");
+    view->line("// Connect GDB to the second serial port of this device:");
+    view->line("//   (gdb) target extended-remote /dev/ttyACM1");
+    view->line("//");
+    view->line("// Host: %s", gdb_bridge->isHostConnected() ? "connected" : "waiting");
+    view->line("// Production trigger and BOOTSEL are disabled in this mode.");
+    view->line("//");
+    view->line("// [G/ESC] BACK TO PRODUCTION");
+    view->line("//===========================================================");
+    view->end();
+}
+
+// Console mode: a short pinned header, command output scrolls below it
+static void drawConsoleUI() {
+    TerminalView* view = terminal_view;
+    view->begin();
+    view->line("//===========================================================");
+    view->line("// PewPewCH32 %s - picorvd console (target on GPIO%d)",
+               PROGRAMMER_VERSION, swio_pin);
+    view->line("// Type 'help' for commands. [ESC] BACK TO PRODUCTION");
+    view->line("//===========================================================");
+    view->end();
+}
+
+// Describe the terminal UI; the view only sends lines that changed
 void drawTerminalUI() {
-    printf("\033[2J\033[H");  // Clear screen + cursor home
-    printf("//===========================================================\n");
-    printf("//\n");
-    printf("// PewPewCH32 %s\n", PROGRAMMER_VERSION);
-    printf("//\n");
+    if (gdb_bridge->isActive()) {
+        drawGdbUI();
+        return;
+    }
+    if (in_console_mode) {
+        drawConsoleUI();
+        return;
+    }
+    if (show_stats) {
+        drawStatsUI();
+        return;
+    }
+
+    TerminalView* view = terminal_view;
+    view->begin();
+    view->line("//===========================================================");
+    view->line("//");
+    view->line("// PewPewCH32 %s", PROGRAMMER_VERSION);
+    view->line("//");
 
 #ifdef FIRMWARE_INVENTORY_ENABLED
+    // Show the page containing the selection; pad short pages so paging
+    // keeps the line count (and thus the incremental redraw) stable
     int selected = g_state_machine->getCurrentFirmwareIndex();
-    printf("// %s [0] WIPE FLASH\n", (selected == 0) ? "-->" : "   ");
-    for (int i = 0; i < firmware_count; i++) {
-        printf("// %s [%d] %s\n", (selected == i + 1) ? "-->" : "   ",
-               i + 1, firmware_list[i].name);
+    int pages = FirmwareMenu::pageCount();
+    int page = FirmwareMenu::pageOf(selected);
+    int first = FirmwareMenu::pageStart(page);
+    for (int i = first; i < first + MENU_PAGE_SIZE; i++) {
+        const firmware_info_t* fw = FirmwareMenu::firmware(i);
+        if (fw && fw->app.valid) {
+            view->line("// %s [%d] %-20s v%u.%u  hw 0x%02X", (selected == i) ? "-->" : "   ",
+                       i, fw->name, fw->app.ver_major, fw->app.ver_minor, fw->app.hw_type);
+        } else if (FirmwareMenu::kind(i) == MENU_RECIPE) {
+            view->line("// %s [%d] %-20s recipe", (selected == i) ? "-->" : "   ",
+                       i, FirmwareMenu::name(i));
+        } else if (i < FirmwareMenu::count()) {
+            view->line("// %s [%d] %s", (selected == i) ? "-->" : "   ",
+                       i, FirmwareMenu::name(i));
+        } else if (pages > 1) {
+            view->line("//");
+        }
+    }
+    view->line("//");
+    if (pages > 1) {
+        view->line("// Page %d/%d  (%d entries)", page + 1, pages, FirmwareMenu::count());
+    }
+    if (in_search) {
+        view->line("// Search: %s_", search_buf);
+    } else if (quick_number >= 0) {
+        view->line("// Select: %d_", quick_number);
+    } else {
+        view->line("//");
     }
-    printf("// %s [9] REBOOT\n", (selected == 9) ? "-->" : "   ");
-    printf("//\n");
-    printf("// [UP/DN] SELECT  [ENTER] FLASH  [0-9] QUICK SELECT\n");
-    printf("// [S] SETUP       [R] REFRESH\n");
+    view->line("// [UP/DN] SELECT  [LT/RT] PAGE  [ENTER] FLASH");
+    view->line("// [0-9] NUMBER    [/] SEARCH    [S] SETUP  [C] CONSOLE");
+    view->line("// [R] REFRESH     [D] DUMP DISPLAY [T] STATS  [L] LOOP TIMING");
+    view->line("// [G] GDB REMOTE  [Q] LOAD BATCH  [B] LOOP BUDGET");
 #else
-    printf("//     [0] fallback (built-in minimal firmware)\n");
-    printf("//\n");
-    printf("// [ENTER] FLASH  [S] SETUP  [R] REFRESH\n");
+    view->line("//     [0] fallback (built-in minimal firmware)");
+    view->line("//");
+    view->line("// [ENTER] FLASH [S] SETUP [C] CONSOLE [R] REFRESH [D] DUMP [T] STATS [L] LOOP");
+    view->line("// [G] GDB REMOTE  [Q] LOAD BATCH  [B] LOOP BUDGET");
+#endif
+
+    view->line("//");
+    view->line("// Status: %s  (swio=GPIO%d)",
+               StateMachine::getStateName(g_state_machine->getCurrentState()), swio_pin);
+    if (in_upload) {
+        view->line("// Batch upload in progress ('.' to end, ESC to abort)");
+    } else if (unit_queue->isActive()) {
+        view->line("// Batch: %d of %d records left",
+                   unit_queue->getRemaining(), unit_queue->getCount());
+    }
+    if (log_buffer->getDroppedBytes()) {
+        view->line("// Log overflow: %lu bytes dropped",
+                   (unsigned long)log_buffer->getDroppedBytes());
+    }
+    view->line("//");
+    view->line("//===========================================================");
+    view->end();
+}
+
+// Idle OLED footer: pass count of the selected image, else its app version,
+// else the programmer version
+static void showSelectedYield(StateMachine* state_machine, DisplayController* display) {
+    const stats_counters_t* c = nullptr;
+    int index = state_machine->getCurrentFirmwareIndex();
+    if (FirmwareMenu::isProduction(index)) {
+        c = production_stats->find(state_machine->getCurrentMenuName());
+    }
+
+    char text[FONT_CHARS_PER_LINE + 1] = "";
+    if (c && c->attempts) {
+        snprintf(text, sizeof(text), "PASS %lu/%lu",
+                 (unsigned long)c->passes, (unsigned long)c->attempts);
+    }
+#ifdef FIRMWARE_INVENTORY_ENABLED
+    const firmware_info_t* fw = FirmwareMenu::firmware(index);
+    if (!text[0] && fw && fw->app.valid) {
+        snprintf(text, sizeof(text), "APP v%u.%u HW %02X",
+                 fw->app.ver_major, fw->app.ver_minor, fw->app.hw_type);
+    }
 #endif
+    display->setIdleInfo(text);
+}
 
-    printf("//\n");
-    printf("// Status: %s  (swio=GPIO%d)\n",
-           StateMachine::getStateName(g_state_machine->getCurrentState()), swio_pin);
-    printf("//\n");
-    printf("//===========================================================\n");
+// Move the selection: state machine, OLED and (unsaved) settings
+static void selectMenuEntry(StateMachine* state_machine, DisplayController* display,
+                            Settings* settings, int index) {
+    state_machine->setCurrentFirmwareIndex(index);
+    display->setMenuEntry(state_machine->getCurrentMenuName(), index,
+                          FirmwareMenu::count());
+    showSelectedYield(state_machine, display);
+    settings->setLastFirmwareIndex(index);
 }
 
 // Flag for terminal redraw from main loop
 static bool needs_terminal_redraw = false;
 
+// One key of a batch upload. Bad lines are reported and skipped; the final
+// count tells the host how many records were taken.
+static void uploadKey(int key) {
+    if (key == KEY_ESCAPE) {
+        in_upload = false;
+        unit_queue->clear();
+        printf_g("// QUEUE upload aborted, batch cleared\n");
+        needs_terminal_redraw = true;
+    } else if (key == KEY_ENTER || key == '\n') {
+        upload_line[upload_len] = '\0';
+        upload_len = 0;
+        if (upload_overflow) {
+            // A cut line could still parse, with truncated patch data
+            upload_overflow = false;
+            upload_line_no++;
+            upload_errors++;
+            printf_g("// QUEUE line %d rejected: line too long (max %d)\n",
+                     upload_line_no, UPLOAD_LINE_MAX);
+            return;
+        }
+        if (upload_line[0] == '\0') return;
+        if (strcmp(upload_line, ".") == 0) {
+            in_upload = false;
+            printf_g("// QUEUE loaded %d records (%d rejected)\n",
+                     unit_queue->getCount(), upload_errors);
+            needs_terminal_redraw = true;
+            return;
+        }
+        upload_line_no++;
+        const char* error = nullptr;
+        if (!unit_queue->addLine(upload_line, &error)) {
+            upload_errors++;
+            printf_g("// QUEUE line %d rejected: %s\n", upload_line_no, error);
+        }
+    } else if ((key == 0x08 || key == 0x7F) && upload_len > 0) {
+        upload_len--;
+    } else if (key >= 0x20 && key < 0x7F) {
+        if (upload_len < UPLOAD_LINE_MAX) {
+            upload_line[upload_len++] = (char)key;
+        } else {
+            upload_overflow = true;
+        }
+    }
+}
+
+// Low-power idle wake check, called with interrupts masked after every
+// interrupt: a button edge (trigger IRQ or BOOTSEL sampler), a button still
+// held, or USB activity (received bytes, host attach/detach)
+static const char* idleWakeSource() {
+    if (input_obj.hasPendingEdges() || !gpio_get(PIN_TRIGGER)) return "trigger/BOOTSEL";
+    if (tud_cdc_n_available(USB_CDC_TERMINAL) || tud_cdc_n_available(USB_CDC_GDB)) return "USB data";
+    if (tud_mounted() != idle_usb_mounted ||
+        tud_cdc_n_connected(USB_CDC_TERMINAL) != idle_usb_connected) return "USB host";
+    return nullptr;
+}
+
 int main() {
     stdio_init_all();
 
+    // Buffer all output so a slow or absent host never stalls us
+    log_buffer->init();
+
     // Give USB serial time to initialize
     sleep_ms(1000);
 
+    // CRC engine before anything that validates stored data
+    Crc32::init();
+
     // Initialize persistent settings (first — display depends on it)
-    Settings* settings = new Settings();
+    Settings* settings = &settings_obj;
     settings->init();
     swio_pin = settings->getSwioPin();
 
     // Initialize display
-    DisplayController* display = new DisplayController();
+    DisplayController* display = &display_obj;
     display->init(settings->getDisplayFlip());
+    if (display->isPresent()) {
+        settings->setDisplayI2cKhz(display->getI2cFreq() / 1000);
+        settings->save();  // No-op unless the negotiated rate changed
+    }
     display->setSleepTimeout(SLEEP_TIMEOUT_OPTIONS[settings->getSleepTimeoutIndex()]);
+    low_power_idle->setTimeout(SLEEP_TIMEOUT_OPTIONS[settings->getSleepTimeoutIndex()]);
+
+    // Production counters (flash journal below the settings)
+    production_stats->init();
 
     // Initialize controllers
-    LedController* led = new LedController();
+    LedController* led = &led_obj;
     led->init();
 
-    BuzzerController* buzzer = new BuzzerController();
+    BuzzerController* buzzer = &buzzer_obj;
     buzzer->init();
 
-    InputHandler* input = new InputHandler();
+    InputHandler* input = &input_obj;
     input->init();
 
+    // Target supply switch (powers the target up if fitted)
+    if (settings->getPowerPin() != swio_pin) {
+        target_power->configure(settings->getPowerPin(), settings->getPowerActiveLow(),
+                                settings->getPowerOffMs(), settings->getPowerAttachMs());
+    }
+
     // Rainbow startup animation
     led->rainbowAnimation();
 
@@ -116,61 +419,60 @@ int main() {
 
     // Initialize debug interfaces
     printf_g("// Initializing PicoSWIO on GPIO%d\n", swio_pin);
-    PicoSWIO* swio = new PicoSWIO();
+    PicoSWIO* swio = &swio_obj;
     swio->reset(swio_pin);
 
     printf_g("// Initializing RVDebug\n");
-    RVDebug* rvd = new RVDebug(swio, 16);
+    RVDebug* rvd = &rvd_obj;
     rvd->init();
 
     printf_g("// Initializing WCHFlash\n");
-    WCHFlash* flash = new WCHFlash(rvd, ch32v003_flash_size);
+    WCHFlash* flash = &flash_obj;
     flash->reset();
 
     printf_g("// Initializing SoftBreak\n");
-    SoftBreak* soft = new SoftBreak(rvd, flash);
+    SoftBreak* soft = &soft_obj;
     soft->init();
 
     printf_g("// Initializing GDBServer\n");
-    GDBServer* gdb = new GDBServer(rvd, flash, soft);
+    GDBServer* gdb = &gdb_obj;
     gdb->reset();
 
     printf_g("// Initializing Console\n");
-    Console* console = new Console(rvd, flash, soft);
+    Console* console = &console_obj;
     console->reset();
 
     // Initialize state machine
-    StateMachine* state_machine = new StateMachine(led, rvd, flash);
+    StateMachine* state_machine = g_state_machine;
+    state_machine->init();
     state_machine->setDisplayController(display);
     state_machine->setDebugBus(swio, swio_pin);
-    g_state_machine = state_machine;
-
-    // Create setup screen
-    setup_screen = new SetupScreen();
+    state_machine->setLogBuffer(log_buffer);
+    state_machine->setProductionStats(production_stats);
+    state_machine->setUnitQueue(unit_queue);
+    state_machine->setTargetPower(target_power);
 
     // Restore last firmware selection from settings
     int last_idx = settings->getLastFirmwareIndex();
-#ifdef FIRMWARE_INVENTORY_ENABLED
-    if (last_idx >= 0 && (last_idx <= firmware_count || last_idx == 9)) {
-        state_machine->setCurrentFirmwareIndex(last_idx);
-    } else {
-        state_machine->setCurrentFirmwareIndex(1);
+    if (!FirmwareMenu::isValid(last_idx)) {
+        last_idx = FirmwareMenu::count() > 1 ? 1 : 0;
     }
-#else
-    state_machine->setCurrentFirmwareIndex(0);
-#endif
 
     // Set initial display content
-    display->setMenuEntry(state_machine->getCurrentMenuName());
+    selectMenuEntry(state_machine, display, settings, last_idx);
     display->setSystemState(STATE_IDLE);
 
     printf_g("// CH32V003 Programmer Ready!\n");
 
-    console->start();
-
     // Initial terminal UI draw
     drawTerminalUI();
 
+    // Main-loop timing ('L' on the terminal)
+    LoopMonitor* loop_monitor = &loop_monitor_obj;
+
+    // Inactivity counts from here
+    low_power_idle->noteActivity();
+
     // Track state changes for terminal redraw + sounds
     SystemState last_state = STATE_IDLE;
 
@@ -181,17 +483,86 @@ int main() {
     // Main loop
     while (1) {
         // Update all controllers
+        loop_monitor->begin();
+        log_buffer->drain();
+        loop_monitor->mark(SECTION_LOG);
         led->update();
+        loop_monitor->mark(SECTION_LED);
         display->update();
+        loop_monitor->mark(SECTION_DISPLAY);
+
+        // GDB remote mode: the second USB port belongs to GDBServer and the
+        // production flow is parked until the mode is left
+        if (gdb_bridge->isActive()) {
+            bool host_was_connected = gdb_bridge->isHostConnected();
+            bool moved = gdb_bridge->update();
+            if (gdb_bridge->isHostConnected() != host_was_connected) {
+                needs_terminal_redraw = true;
+            }
+            loop_monitor->mark(SECTION_DEBUG);
+
+            input->update(false);
+            int key = keys->poll();
+            if (key == 'g' || key == 'G' || key == KEY_ESCAPE) {
+                gdb_bridge->end();
+                printf_g("// GDB remote mode off\n");
+                showSelectedYield(state_machine, display);
+                terminal_view->invalidate();
+                needs_terminal_redraw = true;
+            }
+            loop_monitor->mark(SECTION_INPUT);
+
+            if (needs_terminal_redraw) {
+                needs_terminal_redraw = false;
+                drawTerminalUI();
+            }
+            loop_monitor->mark(SECTION_TERMINAL);
+            loop_monitor->end();
+
+            // Stay responsive while GDB traffic flows
+            if (!moved) sleep_ms(1);
+            continue;
+        }
+
+        // Console mode: raw keys go to the picorvd Console line editor.
+        // Its printf output lands in the log ring like everything else, so
+        // a long dump never blocks the loop; the ring is drained every pass.
+        if (in_console_mode) {
+            input->update(false);
+            int key = keys->poll();
+            if (key == KEY_ESCAPE) {
+                in_console_mode = false;
+                InputHandler::resumeBootsel();
+                printf_g("\n// Console mode off\n");
+                showSelectedYield(state_machine, display);
+                terminal_view->invalidate();
+                needs_terminal_redraw = true;
+            } else {
+                bool ser_ivalid = key >= 0 && key < 0x100;
+                console->update(ser_ivalid, ser_ivalid ? (char)key : 0);
+            }
+            loop_monitor->mark(SECTION_DEBUG);
+
+            if (needs_terminal_redraw) {
+                needs_terminal_redraw = false;
+                drawTerminalUI();
+            }
+            loop_monitor->mark(SECTION_TERMINAL);
+            loop_monitor->end();
+            sleep_ms(1);
+            continue;
+        }
 
         // Setup mode: handle input separately, skip normal processing
         if (in_setup_mode) {
-            int c = getchar_timeout_us(0);
-            if (c != PICO_ERROR_TIMEOUT) {
-                SetupResult result = setup_screen->processInput(c);
+            int key = keys->poll();
+            if (key != KEY_NONE) {
+                SetupResult result = setup_screen->processInput(key);
                 if (result == RESULT_SAVED) {
                     setup_screen->applyToHardware(settings, display, swio, rvd,
-                                                  state_machine, &swio_pin);
+                                                  state_machine, target_power, &swio_pin);
+                    low_power_idle->setTimeout(
+                        SLEEP_TIMEOUT_OPTIONS[settings->getSleepTimeoutIndex()]);
                     in_setup_mode = false;
                     needs_terminal_redraw = true;
                 } else if (result == RESULT_CANCELLED) {
@@ -199,11 +570,14 @@ int main() {
                     needs_terminal_redraw = true;
                 }
             }
+            loop_monitor->mark(SECTION_INPUT);
+            loop_monitor->end();
             sleep_ms(10);
             continue;
         }
 
         state_machine->process();
+        loop_monitor->mark(SECTION_STATE);
 
         // Check for state changes (sounds + terminal redraw)
         SystemState current_state = state_machine->getCurrentState();
@@ -218,19 +592,31 @@ int main() {
                 default:
                     break;
             }
+            if (current_state == STATE_IDLE) {
+                showSelectedYield(state_machine, display);  // Cycle just counted
+            }
             last_state = current_state;
             needs_terminal_redraw = true;
+            low_power_idle->noteActivity();
         }
 
+        loop_monitor->mark(SECTION_EVENTS);
+
+        // Classify queued button edges; presses made while busy are dropped
+        input->update(state_machine->getCurrentState() == STATE_IDLE);
+
         // Handle input only in IDLE state
         if (state_machine->getCurrentState() == STATE_IDLE) {
             // Read HW button events
             bool trigger_fired = input->checkTriggerButton();
-            InputHandler::ButtonEvent bootsel_event = input->getBootselEvent();
+            ButtonEvent bootsel_event = input->getBootselEvent();
+            if (trigger_fired || bootsel_event != BUTTON_NONE) {
+                low_power_idle->noteActivity();
+            }
 
             // Wake display on any HW button press while sleeping
             if (display->isSleeping() &&
-                (trigger_fired || bootsel_event != InputHandler::BUTTON_NONE)) {
+                (trigger_fired || bootsel_event != BUTTON_NONE)) {
                 display->forceRedraw();
                 suppress_buttons_for_wake = true;
             }
@@ -238,7 +624,7 @@ int main() {
             // Clear suppress flag once all buttons are released and no events pending
             if (suppress_buttons_for_wake &&
                 gpio_get(PIN_TRIGGER) && !input->checkBootselButton() &&
-                !trigger_fired && bootsel_event == InputHandler::BUTTON_NONE) {
+                !trigger_fired && bootsel_event == BUTTON_NONE) {
                 suppress_buttons_for_wake = false;
             }
 
@@ -251,15 +637,15 @@ int main() {
                 }
 
                 switch (bootsel_event) {
-                    case InputHandler::BUTTON_SHORT_PRESS:
+                    case BUTTON_SHORT_PRESS:
                         state_machine->startProgramming();
                         break;
 
-                    case InputHandler::BUTTON_LONG_PRESS:
+                    case BUTTON_LONG_PRESS:
                         buzzer->beepWarning();
                         state_machine->cycleFirmware();
+                        showSelectedYield(state_machine, display);
                         settings->setLastFirmwareIndex(state_machine->getCurrentFirmwareIndex());
-                        settings->save();
                         needs_terminal_redraw = true;
                         break;
 
@@ -269,88 +655,211 @@ int main() {
             }
 
             // Check for UART input
-            int c = getchar_timeout_us(0);
-            if (c != PICO_ERROR_TIMEOUT && (c == 's' || c == 'S')) {
+            int key = keys->poll();
+            bool commit_number = false;
+            if (key != KEY_NONE) {
+                low_power_idle->noteActivity();
+            }
+            if (in_upload) {
+                // Take everything already received; a batch is many lines
+                while (key != KEY_NONE) {
+                    uploadKey(key);
+                    key = in_upload ? keys->poll() : KEY_NONE;
+                }
+            } else if (in_search) {
+                // Search mode: printable characters refine the prefix
+                if (key == KEY_ESCAPE) {
+                    in_search = false;
+                    needs_terminal_redraw = true;
+                } else if (key == KEY_ENTER) {
+                    in_search = false;
+                    buzzer->beepStart();
+                    state_machine->startProgramming();
+                } else if ((key == 0x08 || key == 0x7F) && search_len > 0) {
+                    search_buf[--search_len] = '\0';
+                    needs_terminal_redraw = true;
+                } else if (key >= 0x20 && key < 0x7F && search_len < SEARCH_MAX_LEN) {
+                    search_buf[search_len++] = (char)key;
+                    search_buf[search_len] = '\0';
+                    int idx = FirmwareMenu::findByPrefix(search_buf,
+                                                         state_machine->getCurrentFirmwareIndex());
+                    if (idx >= 0) {
+                        selectMenuEntry(state_machine, display, settings, idx);
+                    }
+                    needs_terminal_redraw = true;
+                }
+            } else if (key == 's' || key == 'S') {
                 setup_screen->enter(settings);
                 in_setup_mode = true;
-            } else if (c != PICO_ERROR_TIMEOUT && (c == 'r' || c == 'R')) {
+            } else if (key == 'r' || key == 'R') {
                 display->forceRedraw();
+                terminal_view->invalidate();
                 needs_terminal_redraw = true;
-            } else if (c != PICO_ERROR_TIMEOUT && c >= '0' && c <= '9') {
-                int index = c - '0';
-#ifdef FIRMWARE_INVENTORY_ENABLED
-                bool valid = (index == 0 || index == 9 ||
-                              (index >= 1 && index <= firmware_count));
-#else
-                bool valid = (index == 0);
-#endif
-                if (valid) {
-                    state_machine->setCurrentFirmwareIndex(index);
-                    display->setMenuEntry(state_machine->getCurrentMenuName());
-                    settings->setLastFirmwareIndex(index);
-                    settings->save();
+            } else if (key == 'd' || key == 'D') {
+                // Framebuffer snapshot for golden-image comparison on the host
+                display->dumpPbm();
+                printf("// render=%luus flush=%lu bytes\n",
+                       (unsigned long)display->getLastRenderUs(),
+                       (unsigned long)display->getLastFlushBytes());
+                printf("// bootsel: %lu samples, irq-off last %luus max %luus\n",
+                       (unsigned long)input->getBootselSampleCount(),
+                       (unsigned long)input->getBootselIrqOffLastUs(),
+                       (unsigned long)input->getBootselIrqOffMaxUs());
+            } else if (key == 'l' || key == 'L') {
+                // Loop timing since the last query, then start afresh
+                loop_monitor->report();
+                loop_monitor->reset();
+                printf("// bootsel: %lu samples, irq-off last %luus max %luus\n",
+                       (unsigned long)input->getBootselSampleCount(),
+                       (unsigned long)input->getBootselIrqOffLastUs(),
+                       (unsigned long)input->getBootselIrqOffMaxUs());
+                low_power_idle->report();
+            } else if (key == 'b' || key == 'B') {
+                loop_monitor->nextBudget();
+                if (loop_monitor->getBudgetUs()) {
+                    printf_g("// LOOP budget %luus\n", (unsigned long)loop_monitor->getBudgetUs());
+                } else {
+                    printf_g("// LOOP budget off\n");
+                }
+            } else if (key == 'c' || key == 'C') {
+                // SWIO stays ours until ESC; keep BOOTSEL sampling off it
+                in_console_mode = true;
+                InputHandler::suspendBootsel();
+                display->setIdleInfo("CONSOLE");
+                terminal_view->invalidate();
+                drawTerminalUI();
+                console->reset();
+                console->start();
+            } else if (key == 'q' || key == 'Q') {
+                // New batch replaces the old one
+                unit_queue->begin();
+                in_upload = true;
+                upload_len = 0;
+                upload_overflow = false;
+                upload_line_no = 0;
+                upload_errors = 0;
+                printf_g("// QUEUE ready: KEY ADDR HEX per line, '.' to end\n");
+                needs_terminal_redraw = true;
+            } else if (key == 'g' || key == 'G') {
+                gdb_bridge->begin();
+                printf_g("// GDB remote mode on (second USB serial port)\n");
+                display->setIdleInfo("GDB REMOTE");
+                terminal_view->invalidate();
+                needs_terminal_redraw = true;
+            } else if (key == 't' || key == 'T') {
+                show_stats = !show_stats;
+                terminal_view->invalidate();
+                needs_terminal_redraw = true;
+            } else if (key == '/') {
+                // Name-prefix search; typed characters go to the search
+                in_search = true;
+                search_len = 0;
+                search_buf[0] = '\0';
+                quick_number = -1;
+                needs_terminal_redraw = true;
+            } else if (key >= '0' && key <= '9') {
+                // Multi-digit number entry; commits as soon as no further
+                // digit could form a valid entry, otherwise after a pause
+                int number = (quick_number < 0 ? 0 : quick_number * 10) + (key - '0');
+                quick_number = number;
+                quick_number_ms = to_ms_since_boot(get_absolute_time());
+                commit_number = (number * 10 >= FirmwareMenu::count());
+                needs_terminal_redraw = true;
+            } else if (key == KEY_UP || key == KEY_DOWN) {
+                int idx = state_machine->getCurrentFirmwareIndex();
+                idx = (key == KEY_UP) ? FirmwareMenu::prev(idx) : FirmwareMenu::next(idx);
+                selectMenuEntry(state_machine, display, settings, idx);
+                needs_terminal_redraw = true;
+            } else if (key == KEY_LEFT || key == KEY_RIGHT) {
+                // Page jump, clamped to the ends of the list
+                int idx = state_machine->getCurrentFirmwareIndex();
+                idx += (key == KEY_LEFT) ? -MENU_PAGE_SIZE : MENU_PAGE_SIZE;
+                if (idx < 0) idx = 0;
+                if (idx >= FirmwareMenu::count()) idx = FirmwareMenu::count() - 1;
+                selectMenuEntry(state_machine, display, settings, idx);
+                needs_terminal_redraw = true;
+            } else if (key == KEY_ENTER) {
+                if (quick_number >= 0) {
+                    commit_number = true;
+                } else {
+                    buzzer->beepStart();
+                    state_machine->startProgramming();
+                }
+            }
+
+            // Number entry timed out or complete: select and program
+            if (quick_number >= 0 && !commit_number &&
+                (to_ms_since_boot(get_absolute_time()) - quick_number_ms) >= QUICK_SELECT_TIMEOUT_MS) {
+                commit_number = true;
+            }
+            if (commit_number) {
+                int index = quick_number;
+                quick_number = -1;
+                needs_terminal_redraw = true;
+                if (FirmwareMenu::isValid(index)) {
+                    selectMenuEntry(state_machine, display, settings, index);
                     buzzer->beepStart();
                     state_machine->startProgramming();
                 } else {
                     printf_g("// Invalid selection [%d]\n", index);
                 }
-            } else if (c != PICO_ERROR_TIMEOUT && c == 0x1B) {
-                // Escape sequence: read remaining bytes for arrow keys
-                int c2 = getchar_timeout_us(10000);
-                if (c2 == '[') {
-                    int c3 = getchar_timeout_us(10000);
-#ifdef FIRMWARE_INVENTORY_ENABLED
-                    if (c3 == 'A' || c3 == 'B') {
-                        int idx = state_machine->getCurrentFirmwareIndex();
-                        if (c3 == 'A') {
-                            // UP: previous entry
-                            if (idx == 0) idx = 9;
-                            else if (idx == 9) idx = firmware_count;
-                            else idx--;
-                        } else {
-                            // DOWN: next entry
-                            if (idx == 9) idx = 0;
-                            else if (idx >= firmware_count) idx = 9;
-                            else idx++;
-                        }
-                        state_machine->setCurrentFirmwareIndex(idx);
-                        display->setMenuEntry(state_machine->getCurrentMenuName());
-                        settings->setLastFirmwareIndex(idx);
-                        needs_terminal_redraw = true;
-                    }
-#endif
-                }
-            } else if (c != PICO_ERROR_TIMEOUT && (c == '\r' || c == '\n')) {
-                settings->save();
-                buzzer->beepStart();
-                state_machine->startProgramming();
             }
         }
 
+        loop_monitor->mark(SECTION_INPUT);
+
+        // Commit settings and counters only while idle with no button held,
+        // so a flash write never sits between a trigger and programming
+        bool can_save = state_machine->getCurrentState() == STATE_IDLE &&
+                        gpio_get(PIN_TRIGGER) && !input->checkBootselButton();
+        if (settings->isDirty()) {
+            settings->update(can_save);
+        }
+        production_stats->update(can_save);
+        loop_monitor->mark(SECTION_PERSIST);
+
         // Deferred terminal redraw
         if (needs_terminal_redraw) {
             needs_terminal_redraw = false;
             drawTerminalUI();
         }
+        loop_monitor->mark(SECTION_TERMINAL);
+        loop_monitor->end();
+
+        // Low-power idle: nothing in flight, nothing to persist, buttons
+        // released, screen dark (or absent) and no input for the timeout
+        if (low_power_idle->isDue() &&
+            state_machine->getCurrentState() == STATE_IDLE &&
+            !in_upload && !in_search && quick_number < 0 &&
+            !settings->isDirty() && !production_stats->isDirty() &&
+            !led->isFirmwareIndicationActive() &&
+            (!display->isPresent() || display->isSleeping()) &&
+            gpio_get(PIN_TRIGGER) && !input->checkBootselButton()) {
+            log_buffer->drain();
+            led->stopHeartbeat();
+            led->rgbOff();
+            idle_usb_mounted = tud_mounted();
+            idle_usb_connected = tud_cdc_n_connected(USB_CDC_TERMINAL);
+            input->setBootselSampleMs(BOOTSEL_IDLE_SAMPLE_MS);
+
+            const char* reason = low_power_idle->sleep(idleWakeSource);
+
+            input->setBootselSampleMs(BOOTSEL_SAMPLE_MS);
+            led->startHeartbeat();
+            loop_monitor->skipPeriod();
+            printf_g("// Idle wake (%s), full clock in %luus\n", reason,
+                     (unsigned long)low_power_idle->getLastResumeUs());
+            if (low_power_idle->isHeldOff()) {
+                printf_g("// Idle resume over %uus budget %d times in a row, low-power "
+                         "idle off until the next key or button\n",
+                         IDLE_RESUME_BUDGET_US, IDLE_OVERRUN_LIMIT);
+            }
+            continue;
+        }
 
         // Small delay to prevent CPU hogging
         sleep_ms(10);
     }
 
-    // Cleanup (never reached)
-    delete setup_screen;
-    delete console;
-    delete gdb;
-    delete soft;
-    delete flash;
-    delete rvd;
-    delete swio;
-    delete state_machine;
-    delete display;
-    delete settings;
-    delete input;
-    delete buzzer;
-    delete led;
-
     return 0;
 }
@@ -0,0 +1,31 @@
+#ifndef TUSB_CONFIG_H
+#define TUSB_CONFIG_H
+
+// TinyUSB configuration for the composite device described in
+// usb_descriptors.c: two CDC ports, the terminal (stdio) and GDB remote.
+// Found before the pico_stdio_usb copy because src/ comes first on the
+// include path.
+
+#ifndef CFG_TUSB_RHPORT0_MODE
+#define CFG_TUSB_RHPORT0_MODE   (OPT_MODE_DEVICE)
+#endif
+
+#define CFG_TUSB_OS             OPT_OS_PICO
+
+#define CFG_TUD_ENDPOINT0_SIZE  64
+
+#define CFG_TUD_CDC             2
+#define CFG_TUD_MSC             0
+#define CFG_TUD_HID             0
+#define CFG_TUD_MIDI            0
+#define CFG_TUD_VENDOR          0
+
+// GDB packets are up to a few hundred bytes; the terminal redraws in bursts
+#define CFG_TUD_CDC_RX_BUFSIZE  256
+#define CFG_TUD_CDC_TX_BUFSIZE  512
+
+// CDC interface numbers (tud_cdc_n_*). stdio_usb always uses port 0.
+#define USB_CDC_TERMINAL        0
+#define USB_CDC_GDB             1
+
+#endif // TUSB_CONFIG_H
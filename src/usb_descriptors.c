@@ -0,0 +1,115 @@
+#include <string.h>
+#include "pico/unique_id.h"
+#include "tusb.h"
+
+// Composite device: two CDC ACM ports. The first carries the terminal UI
+// (stdio), the second the GDB remote protocol. Replaces the single-port
+// descriptors of pico_stdio_usb, which steps aside because the executable
+// links tinyusb_device itself.
+
+#define USBD_VID            0x2E8A  // Raspberry Pi
+#define USBD_PID            0x000A  // Pico SDK CDC
+#define USBD_MAX_POWER_MA   250
+
+enum {
+    ITF_NUM_CDC_TERMINAL = 0,
+    ITF_NUM_CDC_TERMINAL_DATA,
+    ITF_NUM_CDC_GDB,
+    ITF_NUM_CDC_GDB_DATA,
+    ITF_NUM_TOTAL
+};
+
+#define EPNUM_CDC_TERMINAL_NOTIF  0x81
+#define EPNUM_CDC_TERMINAL_OUT    0x02
+#define EPNUM_CDC_TERMINAL_IN     0x82
+#define EPNUM_CDC_GDB_NOTIF       0x83
+#define EPNUM_CDC_GDB_OUT         0x04
+#define EPNUM_CDC_GDB_IN          0x84
+
+#define CONFIG_TOTAL_LEN  (TUD_CONFIG_DESC_LEN + CFG_TUD_CDC * TUD_CDC_DESC_LEN)
+
+enum {
+    STRID_LANGID = 0,
+    STRID_MANUFACTURER,
+    STRID_PRODUCT,
+    STRID_SERIAL,
+    STRID_CDC_TERMINAL,
+    STRID_CDC_GDB,
+};
+
+static const tusb_desc_device_t device_descriptor = {
+    .bLength = sizeof(tusb_desc_device_t),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = 0x0200,
+    // IAD-based composite
+    .bDeviceClass = TUSB_CLASS_MISC,
+    .bDeviceSubClass = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol = MISC_PROTOCOL_IAD,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = USBD_VID,
+    .idProduct = USBD_PID,
+    .bcdDevice = 0x0200,
+    .iManufacturer = STRID_MANUFACTURER,
+    .iProduct = STRID_PRODUCT,
+    .iSerialNumber = STRID_SERIAL,
+    .bNumConfigurations = 1
+};
+
+static const uint8_t config_descriptor[] = {
+    TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0, USBD_MAX_POWER_MA),
+    TUD_CDC_DESCRIPTOR(ITF_NUM_CDC_TERMINAL, STRID_CDC_TERMINAL, EPNUM_CDC_TERMINAL_NOTIF, 8,
+                       EPNUM_CDC_TERMINAL_OUT, EPNUM_CDC_TERMINAL_IN, 64),
+    TUD_CDC_DESCRIPTOR(ITF_NUM_CDC_GDB, STRID_CDC_GDB, EPNUM_CDC_GDB_NOTIF, 8,
+                       EPNUM_CDC_GDB_OUT, EPNUM_CDC_GDB_IN, 64),
+};
+
+static const char* const string_descriptors[] = {
+    [STRID_MANUFACTURER] = "PewPewCH32",
+    [STRID_PRODUCT] = "CH32V003 Programmer",
+    [STRID_SERIAL] = NULL,              // Board unique ID, filled in on request
+    [STRID_CDC_TERMINAL] = "PewPewCH32 Terminal",
+    [STRID_CDC_GDB] = "PewPewCH32 GDB",
+};
+
+#define STRING_MAX_CHARS  32
+
+const uint8_t* tud_descriptor_device_cb(void) {
+    return (const uint8_t*)&device_descriptor;
+}
+
+const uint8_t* tud_descriptor_configuration_cb(uint8_t index) {
+    (void)index;
+    return config_descriptor;
+}
+
+const uint16_t* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+    (void)langid;
+    static uint16_t desc[STRING_MAX_CHARS + 1];
+    char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+    const char* str;
+    size_t len;
+
+    if (index == STRID_LANGID) {
+        desc[1] = 0x0409;   // English
+        len = 1;
+    } else {
+        if (index >= sizeof(string_descriptors) / sizeof(string_descriptors[0])) {
+            return NULL;
+        }
+        if (index == STRID_SERIAL) {
+            pico_get_unique_board_id_string(serial, sizeof(serial));
+            str = serial;
+        } else {
+            str = string_descriptors[index];
+        }
+        len = strlen(str);
+        if (len > STRING_MAX_CHARS) len = STRING_MAX_CHARS;
+        for (size_t i = 0; i < len; i++) {
+            desc[1 + i] = (uint8_t)str[i];
+        }
+    }
+
+    // First element: length (bytes, including header) and type
+    desc[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * len + 2));
+    return desc;
+}
@@ -0,0 +1,152 @@
+#include "FakePanel.h"
+#include <string.h>
+#include "hardware/i2c.h"
+
+FakePanel& FakePanel::instance() {
+    static FakePanel panel;
+    return panel;
+}
+
+void FakePanel::reset() {
+    memset(ram, 0, sizeof(ram));
+    display_on = false;
+    seg_remap = false;
+    com_reversed = false;
+    horizontal = false;
+    col = 0;
+    page = 0;
+    col_start = 0;
+    col_end = RAM_WIDTH - 1;
+    page_start = 0;
+    page_end = PAGES - 1;
+    pending_cmd = 0;
+    pending_args = 0;
+    arg_count = 0;
+    resetCounters();
+}
+
+// Control byte 0x00: the rest are command bytes, 0x40: RAM data
+void FakePanel::write(const uint8_t* buf, size_t len) {
+    bytes += len;
+    transfers++;
+    if (len < 1) return;
+    for (size_t i = 1; i < len; i++) {
+        if (buf[0] == 0x40) {
+            data(buf[i]);
+        } else {
+            command(buf[i]);
+        }
+    }
+}
+
+// Number of argument bytes that follow a command
+static int argumentCount(uint8_t cmd) {
+    switch (cmd) {
+        case 0x21: case 0x22:
+            return 2;
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xAD:
+        case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+void FakePanel::command(uint8_t cmd) {
+    if (pending_args) {
+        args[arg_count++] = cmd;
+        if (--pending_args == 0) finishCommand();
+        return;
+    }
+
+    int n = argumentCount(cmd);
+    if (n) {
+        pending_cmd = cmd;
+        pending_args = n;
+        arg_count = 0;
+        return;
+    }
+
+    if (cmd <= 0x0F) {
+        col = (col & 0xF0) | cmd;                   // Column low nibble
+    } else if (cmd <= 0x1F) {
+        col = (col & 0x0F) | ((cmd & 0x0F) << 4);   // Column high nibble
+    } else if (cmd >= 0xB0 && cmd <= 0xB7) {
+        page = cmd & 0x07;                          // Page address
+    } else if (cmd == 0xA0 || cmd == 0xA1) {
+        seg_remap = (cmd == 0xA1);
+    } else if (cmd == 0xC0 || cmd == 0xC8) {
+        com_reversed = (cmd == 0xC8);
+    } else if (cmd == 0xAE || cmd == 0xAF) {
+        display_on = (cmd == 0xAF);
+    }
+    // Start line, contrast-free single-byte commands etc. don't affect RAM
+}
+
+void FakePanel::finishCommand() {
+    switch (pending_cmd) {
+        case 0x20:
+            horizontal = (args[0] == 0x00);
+            break;
+        case 0x21:
+            col_start = args[0];
+            col_end = args[1];
+            col = col_start;
+            break;
+        case 0x22:
+            page_start = args[0];
+            page_end = args[1];
+            page = page_start;
+            break;
+        default:
+            break;
+    }
+}
+
+void FakePanel::data(uint8_t b) {
+    if (page < PAGES && col < RAM_WIDTH) {
+        ram[page][col] = b;
+    }
+    col++;
+    if (horizontal && col > col_end) {
+        col = col_start;
+        page = (page >= page_end) ? page_start : page + 1;
+    }
+}
+
+bool FakePanel::pixel(int x, int y) const {
+    int rx = seg_remap ? x : WIDTH - 1 - x;
+    int ry = com_reversed ? y : HEIGHT - 1 - y;
+    rx += DisplayPanel::COLUMN_OFFSET;
+    return (ram[ry / 8][rx] >> (ry % 8)) & 1;
+}
+
+std::string FakePanel::toPbm() const {
+    std::string out = "P1\n" + std::to_string(WIDTH) + " " + std::to_string(HEIGHT) + "\n";
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            out += pixel(x, y) ? '1' : '0';
+        }
+        out += '\n';
+    }
+    return out;
+}
+
+// hardware/i2c.h stand-in: the panel ACKs everything
+
+struct i2c_inst {};
+static i2c_inst i2c1_inst;
+i2c_inst_t* const i2c1 = &i2c1_inst;
+
+uint i2c_init(i2c_inst_t*, uint baudrate) {
+    return baudrate;
+}
+
+uint i2c_set_baudrate(i2c_inst_t*, uint baudrate) {
+    return baudrate;
+}
+
+int i2c_write_timeout_us(i2c_inst_t*, uint8_t, const uint8_t* src, size_t len, bool, uint) {
+    FakePanel::instance().write(src, len);
+    return (int)len;
+}
@@ -0,0 +1,61 @@
+#ifndef FAKE_PANEL_H
+#define FAKE_PANEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include "DisplayPanel.h"
+
+// Host model of the OLED controller behind the I2C stub: decodes the
+// command/data stream DisplayController sends (addressing mode, column and
+// page windows, SH1106 page addressing, segment remap, COM scan direction,
+// display on/off) into controller RAM, so the harness checks what the
+// panel would actually show rather than the framebuffer alone.
+class FakePanel {
+public:
+    static constexpr int WIDTH = DisplayPanel::WIDTH;
+    static constexpr int HEIGHT = DisplayPanel::HEIGHT;
+    static constexpr int PAGES = HEIGHT / 8;
+    static constexpr int RAM_WIDTH = WIDTH + 2 * DisplayPanel::COLUMN_OFFSET;
+
+    static FakePanel& instance();
+
+    void reset();
+    void write(const uint8_t* buf, size_t len);
+
+    // Pixel as seen on the module mounted the normal way up (the
+    // controller's A1/C8 orientation); flip rotates the image by 180 degrees
+    bool pixel(int x, int y) const;
+    bool isOn() const { return display_on; }
+
+    // Traffic since the last resetCounters()
+    void resetCounters() { bytes = 0; transfers = 0; }
+    uint32_t getBytes() const { return bytes; }
+    uint32_t getTransfers() const { return transfers; }
+
+    // Plain (ASCII) PBM of the visible image
+    std::string toPbm() const;
+
+private:
+    uint8_t ram[PAGES][RAM_WIDTH];
+    bool display_on;
+    bool seg_remap;         // A1: column 0 on the left as mounted
+    bool com_reversed;      // C8: row 0 at the top as mounted
+    bool horizontal;        // 0x20 0x00 (SSD1306); page addressing otherwise
+    int col, page;
+    int col_start, col_end, page_start, page_end;
+
+    uint8_t pending_cmd;    // Command still collecting arguments
+    int pending_args;
+    uint8_t args[2];
+    int arg_count;
+
+    uint32_t bytes;
+    uint32_t transfers;
+
+    void command(uint8_t cmd);
+    void finishCommand();
+    void data(uint8_t b);
+};
+
+#endif // FAKE_PANEL_H
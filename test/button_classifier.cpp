@@ -0,0 +1,162 @@
+// Host unit test for ButtonClassifier and InputEventQueue, driven with
+// synthetic timestamps (the classifier takes its clock as arguments).
+
+#include <stdio.h>
+#include "ButtonClassifier.h"
+#include "InputEventQueue.h"
+#include "InputHandler.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static const uint32_t SHORT_MS = BOOTSEL_SHORT_PRESS_MS;  // 250
+static const uint32_t LONG_MS = BOOTSEL_LONG_PRESS_MS;    // 750
+
+// Press at t, release after duration; returns the release result
+static ButtonEvent tap(ButtonClassifier& b, uint32_t t, uint32_t duration) {
+    ButtonEvent e = b.feed(true, t);
+    if (e != BUTTON_NONE) return e;
+    return b.feed(false, t + duration);
+}
+
+static void testShortPress() {
+    ButtonClassifier b(SHORT_MS, LONG_MS);
+    CHECK(tap(b, 1000, 40) == BUTTON_SHORT_PRESS);
+    CHECK(!b.isPressed());
+    CHECK(tap(b, 2000, SHORT_MS - 1) == BUTTON_SHORT_PRESS);
+}
+
+static void testBoundaries() {
+    ButtonClassifier b(SHORT_MS, LONG_MS);
+
+    // 250 ms is no longer short, 749 ms not yet long: no event
+    CHECK(tap(b, 1000, SHORT_MS) == BUTTON_NONE);
+    CHECK(tap(b, 2000, LONG_MS - 1) == BUTTON_NONE);
+
+    // Released at exactly 750 ms without a poll in between
+    CHECK(tap(b, 3000, LONG_MS) == BUTTON_LONG_PRESS);
+
+    // Held: poll reports HELD until 750 ms, then LONG exactly once
+    CHECK(b.feed(true, 5000) == BUTTON_NONE);
+    CHECK(b.poll(5000 + SHORT_MS) == BUTTON_HELD);
+    CHECK(b.poll(5000 + LONG_MS - 1) == BUTTON_HELD);
+    CHECK(b.poll(5000 + LONG_MS) == BUTTON_LONG_PRESS);
+    CHECK(b.poll(5000 + LONG_MS + 500) == BUTTON_NONE);
+    CHECK(b.feed(false, 5000 + 2000) == BUTTON_NONE);  // Already reported
+    CHECK(b.poll(9000) == BUTTON_NONE);                 // Released: idle
+}
+
+static void testLongPress() {
+    ButtonClassifier b(SHORT_MS, LONG_MS);
+    CHECK(tap(b, 1000, 3000) == BUTTON_LONG_PRESS);
+
+    // Late polling doesn't change the classification: the edges decide
+    CHECK(b.feed(true, 10000) == BUTTON_NONE);
+    CHECK(b.feed(false, 10100) == BUTTON_SHORT_PRESS);
+    CHECK(b.poll(20000) == BUTTON_NONE);
+}
+
+static void testEdgeCases() {
+    ButtonClassifier b(SHORT_MS, LONG_MS);
+
+    // Release without a press (button held at boot), repeated press edge
+    CHECK(b.feed(false, 100) == BUTTON_NONE);
+    CHECK(b.feed(true, 1000) == BUTTON_NONE);
+    CHECK(b.feed(true, 1200) == BUTTON_NONE);   // Keeps the first press time
+    CHECK(b.feed(false, 1000 + SHORT_MS) == BUTTON_NONE);
+
+    // Millisecond counter wrapping mid-press
+    CHECK(tap(b, 0xFFFFFFF0u, 100) == BUTTON_SHORT_PRESS);
+    CHECK(b.feed(true, 0xFFFFFF00u) == BUTTON_NONE);
+    CHECK(b.poll(0xFFFFFF00u + LONG_MS) == BUTTON_LONG_PRESS);
+    CHECK(b.feed(false, 0xFFFFFF00u + LONG_MS + 10) == BUTTON_NONE);
+}
+
+static void testQueue() {
+    InputEventQueue q;
+    input_event_t ev;
+    CHECK(q.isEmpty());
+    CHECK(!q.pop(&ev));
+
+    // FIFO order, source and timestamps preserved
+    CHECK(q.push(INPUT_BOOTSEL, true, 10));
+    CHECK(q.push(INPUT_TRIGGER, false, 20));
+    CHECK(!q.isEmpty());
+    CHECK(q.pop(&ev) && ev.source == INPUT_BOOTSEL && ev.pressed && ev.time_ms == 10);
+    CHECK(q.pop(&ev) && ev.source == INPUT_TRIGGER && !ev.pressed && ev.time_ms == 20);
+    CHECK(q.isEmpty());
+
+    // Overflow: the newest edges are dropped and counted
+    for (uint32_t i = 0; i < INPUT_EVENT_QUEUE_SIZE; i++) {
+        CHECK(q.push(INPUT_BOOTSEL, (i & 1) == 0, 100 + i));
+    }
+    CHECK(!q.push(INPUT_BOOTSEL, true, 999));
+    CHECK(!q.push(INPUT_BOOTSEL, false, 1000));
+    CHECK(q.getDropped() == 2);
+    for (uint32_t i = 0; i < INPUT_EVENT_QUEUE_SIZE; i++) {
+        CHECK(q.pop(&ev) && ev.time_ms == 100 + i);
+    }
+    CHECK(!q.pop(&ev));
+
+    // Indices keep working across many wraps of the ring
+    for (uint32_t i = 0; i < 10 * INPUT_EVENT_QUEUE_SIZE + 3; i++) {
+        CHECK(q.push(INPUT_TRIGGER, true, i));
+        CHECK(q.pop(&ev) && ev.time_ms == i);
+    }
+    CHECK(q.getDropped() == 2);
+}
+
+// Edges lost to overflow leave the classifier out of step with the pin;
+// resync() (called by InputHandler::update() after drops) realigns it
+static void testResync() {
+    InputEventQueue q;
+    ButtonClassifier b(SHORT_MS, LONG_MS);
+    input_event_t ev;
+
+    // Queue full of other edges when the release arrives: it's lost
+    CHECK(q.push(INPUT_BOOTSEL, true, 1000));
+    for (uint32_t i = 1; i < INPUT_EVENT_QUEUE_SIZE; i++) {
+        CHECK(q.push(INPUT_TRIGGER, (i & 1) == 0, 1000 + i));
+    }
+    CHECK(!q.push(INPUT_BOOTSEL, false, 1100));
+    while (q.pop(&ev)) {
+        if (ev.source == INPUT_BOOTSEL) b.feed(ev.pressed, ev.time_ms);
+    }
+    CHECK(b.isPressed());   // Stuck pressed
+
+    // Level is released: adopt it; no phantom long press later
+    b.resync(false, 1200);
+    CHECK(!b.isPressed());
+    CHECK(b.poll(5000) == BUTTON_NONE);
+
+    // Matching level is a no-op
+    CHECK(b.resync(false, 6000) == BUTTON_NONE);
+    CHECK(!b.isPressed());
+
+    // A lost press: resync starts the press at the resync time
+    CHECK(b.resync(true, 7000) == BUTTON_NONE);
+    CHECK(b.isPressed());
+    CHECK(b.poll(7050) == BUTTON_HELD);
+    CHECK(b.feed(false, 7100) == BUTTON_SHORT_PRESS);
+
+    // Normal classification afterwards
+    CHECK(tap(b, 9000, 50) == BUTTON_SHORT_PRESS);
+}
+
+int main() {
+    testShortPress();
+    testBoundaries();
+    testLongPress();
+    testEdgeCases();
+    testQueue();
+    testResync();
+
+    printf("// button_classifier: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
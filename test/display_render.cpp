@@ -0,0 +1,211 @@
+// Host render harness for DisplayController: renders every SystemState in
+// both orientations, plus an overlong menu name, idle info and a progress
+// bar, through the real render/flush path into FakePanel. Each result is
+// compared with a golden PBM and the flush byte counts with the golden
+// report; render times (host CPU) are reported alongside.
+//
+//   display_render_<panel>             compare against test/golden/<panel>/
+//   display_render_<panel> --update    rewrite the goldens
+//
+// A mismatching image is written next to the binary for diffing.
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include "DisplayController.h"
+#include "FakePanel.h"
+#include "pico/stdlib.h"
+
+extern const char* const PROGRAMMER_VERSION = "host";
+
+struct render_result_t {
+    std::string name;
+    std::string pbm;
+    uint32_t flush_bytes;
+    uint32_t render_us;
+};
+
+static const SystemState ALL_STATES[] = {
+    STATE_IDLE, STATE_CHECKING_TARGET, STATE_PROGRAMMING,
+    STATE_CYCLING_FIRMWARE, STATE_SUCCESS, STATE_ERROR
+};
+
+static const char* stateTag(SystemState state) {
+    switch (state) {
+        case STATE_IDLE:             return "idle";
+        case STATE_CHECKING_TARGET:  return "checking";
+        case STATE_PROGRAMMING:      return "programming";
+        case STATE_CYCLING_FIRMWARE: return "cycling";
+        case STATE_SUCCESS:          return "success";
+        case STATE_ERROR:            return "error";
+        default:                     return "unknown";
+    }
+}
+
+// Fresh controller on a fresh panel, content set up by the case
+static DisplayController* setUp(bool flipped) {
+    static DisplayController* dc = nullptr;
+    delete dc;
+    FakePanel::instance().reset();
+    host_clock_set_ms(1000);
+    dc = new DisplayController();
+    dc->init(flipped);
+    return dc;
+}
+
+// Full redraw via update(); counts the bytes of that flush only
+static render_result_t finish(DisplayController* dc, const std::string& name) {
+    FakePanel& panel = FakePanel::instance();
+    panel.resetCounters();
+    dc->update();
+
+    render_result_t r;
+    r.name = name;
+    r.pbm = panel.toPbm();
+    r.flush_bytes = dc->getLastFlushBytes();
+    r.render_us = dc->getLastRenderUs();
+    if (r.flush_bytes != panel.getBytes()) {
+        fprintf(stderr, "%s: controller counted %u flush bytes, panel saw %u\n",
+                name.c_str(), (unsigned)r.flush_bytes, (unsigned)panel.getBytes());
+        r.flush_bytes = UINT32_MAX;
+    }
+    if (!panel.isOn()) {
+        fprintf(stderr, "%s: panel left off\n", name.c_str());
+        r.flush_bytes = UINT32_MAX;
+    }
+    return r;
+}
+
+static std::vector<render_result_t> renderAll() {
+    std::vector<render_result_t> results;
+    for (int flipped = 0; flipped <= 1; flipped++) {
+        std::string orient = flipped ? "_flipped" : "";
+
+        for (SystemState state : ALL_STATES) {
+            DisplayController* dc = setUp(flipped);
+            dc->setMenuEntry("X3[SD-WD] app", 2, 5);
+            dc->setSystemState(state);
+            results.push_back(finish(dc, std::string(stateTag(state)) + orient));
+        }
+
+        DisplayController* dc = setUp(flipped);
+        dc->setMenuEntry("An-overlong-firmware-image-name", 12, 40);
+        dc->setSystemState(STATE_IDLE);
+        results.push_back(finish(dc, "long_name" + orient));
+
+        dc = setUp(flipped);
+        dc->setMenuEntry("BootLoader", 1, 5);
+        dc->setSystemState(STATE_IDLE);
+        dc->setIdleInfo("Y 98.5% 197/200");
+        results.push_back(finish(dc, "idle_info" + orient));
+
+        // Progress draws and flushes the bottom page itself
+        dc = setUp(flipped);
+        dc->setMenuEntry("X3[SD-WD] app", 2, 5);
+        dc->setSystemState(STATE_PROGRAMMING);
+        dc->update();
+        FakePanel::instance().resetCounters();
+        host_clock_advance_ms(DISPLAY_PROGRESS_INTERVAL_MS);
+        dc->setProgress(3, 8, 4200);
+        render_result_t r;
+        r.name = "progress" + orient;
+        r.pbm = FakePanel::instance().toPbm();
+        r.flush_bytes = dc->getLastFlushBytes();
+        r.render_us = 0;
+        results.push_back(r);
+    }
+    return results;
+}
+
+static bool readFile(const std::string& path, std::string* out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    std::stringstream ss;
+    ss << f.rdbuf();
+    *out = ss.str();
+    return true;
+}
+
+static void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream f(path, std::ios::binary);
+    f << content;
+}
+
+// Report: one "name flush_bytes render_us" line per case
+static std::string makeReport(const std::vector<render_result_t>& results) {
+    std::string out = "# " PANEL_TAG ": case flush_bytes render_us(host)\n";
+    char line[96];
+    for (const render_result_t& r : results) {
+        snprintf(line, sizeof(line), "%-22s %6u %6u\n", r.name.c_str(),
+                 (unsigned)r.flush_bytes, (unsigned)r.render_us);
+        out += line;
+    }
+    return out;
+}
+
+static std::map<std::string, uint32_t> parseFlushBytes(const std::string& report) {
+    std::map<std::string, uint32_t> bytes;
+    std::istringstream in(report);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        uint32_t flush_bytes;
+        if (fields >> name >> flush_bytes) bytes[name] = flush_bytes;
+    }
+    return bytes;
+}
+
+int main(int argc, char** argv) {
+    bool update = argc > 1 && strcmp(argv[1], "--update") == 0;
+    std::string golden_dir = std::string(GOLDEN_DIR) + "/" PANEL_TAG "/";
+
+    std::vector<render_result_t> results = renderAll();
+    std::string report = makeReport(results);
+    printf("%s", report.c_str());
+
+    if (update) {
+        for (const render_result_t& r : results) {
+            writeFile(golden_dir + r.name + ".pbm", r.pbm);
+        }
+        writeFile(golden_dir + "report.txt", report);
+        printf("// goldens updated in %s\n", golden_dir.c_str());
+        return 0;
+    }
+
+    int failures = 0;
+    std::string golden_report;
+    if (!readFile(golden_dir + "report.txt", &golden_report)) {
+        fprintf(stderr, "missing %sreport.txt (run with --update)\n", golden_dir.c_str());
+        return 1;
+    }
+    std::map<std::string, uint32_t> golden_bytes = parseFlushBytes(golden_report);
+
+    for (const render_result_t& r : results) {
+        std::string golden;
+        if (!readFile(golden_dir + r.name + ".pbm", &golden)) {
+            fprintf(stderr, "%s: no golden image\n", r.name.c_str());
+            failures++;
+        } else if (golden != r.pbm) {
+            fprintf(stderr, "%s: image differs from golden, see %s.pbm\n",
+                    r.name.c_str(), r.name.c_str());
+            writeFile(r.name + ".pbm", r.pbm);
+            failures++;
+        }
+        auto it = golden_bytes.find(r.name);
+        if (it == golden_bytes.end() || it->second != r.flush_bytes) {
+            fprintf(stderr, "%s: %u flush bytes, golden %s\n", r.name.c_str(),
+                    (unsigned)r.flush_bytes,
+                    it == golden_bytes.end() ? "missing" : std::to_string(it->second).c_str());
+            failures++;
+        }
+    }
+
+    printf("// %d cases, %d failures\n", (int)results.size(), failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,22 @@
+#include "pico/stdlib.h"
+#include <chrono>
+
+// Fake clock behind get_absolute_time(), in microseconds
+static uint64_t fake_time_us = 0;
+
+absolute_time_t get_absolute_time() {
+    return fake_time_us;
+}
+
+void host_clock_set_ms(uint32_t ms) {
+    fake_time_us = (uint64_t)ms * 1000;
+}
+
+void host_clock_advance_ms(uint32_t ms) {
+    fake_time_us += (uint64_t)ms * 1000;
+}
+
+uint64_t time_us_64() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,17 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+// Host stand-in for hardware/i2c.h: every write goes to the FakePanel
+// (see FakePanel.h), which always ACKs
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t* const i2c1;
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate);
+uint i2c_set_baudrate(i2c_inst_t* i2c, uint baudrate);
+int i2c_write_timeout_us(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len,
+                         bool nostop, uint timeout_us);
+
+#endif // HOST_HARDWARE_I2C_H
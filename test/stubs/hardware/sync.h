@@ -0,0 +1,8 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+// Host stand-in for hardware/sync.h (single-threaded tests)
+
+static inline void __dmb() { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+#endif // HOST_HARDWARE_SYNC_H
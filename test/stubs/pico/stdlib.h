@@ -0,0 +1,31 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+// Host stand-in for the parts of pico/stdlib.h the tested modules use.
+// get_absolute_time() follows a fake clock the test advances by hand;
+// time_us_32/64() read the host's monotonic clock, so render timings are
+// real (host CPU, not RP2040).
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint64_t absolute_time_t;
+typedef unsigned int uint;
+
+absolute_time_t get_absolute_time();
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+uint64_t time_us_64();
+static inline uint32_t time_us_32() { return (uint32_t)time_us_64(); }
+
+// Fake clock control
+void host_clock_set_ms(uint32_t ms);
+void host_clock_advance_ms(uint32_t ms);
+
+#define GPIO_FUNC_I2C 3
+static inline void gpio_set_function(uint, int) {}
+static inline void gpio_pull_up(uint) {}
+static inline void sleep_ms(uint32_t) {}
+
+#define __not_in_flash_func(name) name
+
+#endif // HOST_PICO_STDLIB_H
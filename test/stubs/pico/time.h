@@ -0,0 +1,12 @@
+#ifndef HOST_PICO_TIME_H
+#define HOST_PICO_TIME_H
+
+// Host stand-in for pico/time.h (types only)
+
+#include "pico/stdlib.h"
+
+typedef struct repeating_timer {
+    int unused;
+} repeating_timer_t;
+
+#endif // HOST_PICO_TIME_H